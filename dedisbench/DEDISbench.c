@@ -16,6 +16,7 @@
 #include <malloc.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sched.h>
 #include <errno.h>
 #include <dirent.h>
 #include "parserconf/inih/ini.h"
@@ -23,30 +24,39 @@
 #include "utils/random/random.h"
 #include "benchcore/duplicates/duplicatedist.h"
 #include "benchcore/accesses/iodist.h"
+#include "benchcore/accesses/counts.h"
 #include "utils/db/berk.h"
 #include "benchcore/sharedmem/sharedmem.h"
 #include "populate/populate.h"
+#include "populate/popcache.h"
 #include "structs/defines.h"
 #include "benchcore/io.h"
+#include "benchcore/content/content.h"
+#include "benchcore/phases/phases.h"
+#include "benchcore/replay/replay.h"
+#include "benchcore/tracker/tracker.h"
+#include "benchcore/integrity/integrity.h"
+#include "benchcore/regions/regions.h"
 #include "io/plotio.h"
+#include "io/trace.h"
+#include "io/snapshots.h"
+#include "io/metrics.h"
 #include "utils/utils.h"
+#include "utils/timing/timing.h"
 
 #include "benchcore/faults/fault.h"
 #include "benchcore/faults/dedupDegree.h"
 #include "benchcore/faults/configParserYaml.h"
 
 //time elapsed since last I/O
-long lap_time(struct timeval *base) {
-	struct timeval tv;
+long lap_time(uint64_t *base, uint64_t now) {
 	long delta;
 
-	//get current time
-	gettimeofday(&tv, NULL); 
 	//base time - current time (in microseconds)
-	delta = (tv.tv_sec-base->tv_sec)*1e6+(tv.tv_usec-base->tv_usec);
+	delta = (now-*base)/1000;
 
-	//update base to the current time
-    *base = tv;
+	//update base to the current time, keeping the sub-microsecond remainder
+    *base = now-((now-*base)%1000);
 
     //return delta
 	return delta;
@@ -57,6 +67,23 @@ void idle(long quantum) {
 	usleep(quantum);
 }
 
+//wait until the time (ns) when a replayed request is due, returns how late it is issued
+uint64_t replay_wait(uint64_t due) {
+	uint64_t now=now_ns();
+
+	//sleep while the request is far from being due and yield in the last 2 ms
+	while(now<due){
+		if(due-now>2000000){
+			usleep((due-now)/1000-1000);
+		}else{
+			sched_yield();
+		}
+		now=now_ns();
+	}
+
+	return now-due;
+}
+
 
 //create the log file with the results from the test
 FILE* create_plog(int procid){
@@ -96,14 +123,21 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 	procid_r=procid_r+(conf->nprocs/2);
 	  
 	//Init IO and content structures (random generator, etc)
-  	init_io(conf, procid_r);
+  	init_io(conf, &stat, procid_r);
 
   }else{
-  	init_io(conf, idproc);
+  	init_io(conf, &stat, idproc);
 
   }
 
 
+  //hot duplicated blocks are rendered once per process
+  init_content_cache(conf->content_cache, conf->block_size);
+
+  //unique content ids and duplicate counters of the process (see duplicatedist)
+  init_unique_ids(info, procid_r+1);
+  init_dup_shard(info);
+
   if(conf->rawdevice==0){
 	  //create file where process will perform I/O
 	  fd_test = create_pfile(idproc,conf);
@@ -127,49 +161,67 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 
   }
 
+  //live stats page read by the metrics endpoint
+  struct metrics_page* mpage=NULL;
+  if(conf->metricsf==1){
+	  mpage = &conf->metrics[procid_r];
+	  metrics_start(mpage, procid_r, iotype);
+  }
+
+  //binary trace of every operation written asynchronously
+  struct trace_log* tlog=NULL;
+  if(conf->logfeature==2){
+	  tlog = trace_open(procid_r, iotype, conf);
+  }
+
+  //requests of a trace replace the synthesized ones
+  struct replay_reader* rr=NULL;
+  uint64_t replay_late=0;
+  if(conf->replay==1){
+	  rr = replay_open(conf->replayfile, procid_r, conf->nprocs);
+  }
+
   char ifilename[PATH_SIZE];
   int integrity_errors=0;
-  if(conf->integrity>=2 && iotype==READ){
+  if(conf->integrity>=2 && (iotype==READ || rr)){
 	strcpy(ifilename,"./results/intgr_online_check");
   	strcat(ifilename,id);
   	fpi=fopen(ifilename,"w");
   	fprintf(fpi, "Integrity Check results for process %d\n",procid_r);
   }
+  //bodies of the blocks read are verified out of the I/O loop
+  struct verifier* ver=NULL;
+  if(fpi){
+	  ver = verifier_start(conf, fpi);
+  }
 
-  uint64_t* acessesarray=NULL;
-  //init acesses array
-
-  acessesarray=malloc(sizeof(uint64_t)*conf->totblocks);
-  uint64_t aux;
-  for(aux=0;aux<conf->totblocks;aux++){
+  //accesses to the blocks of the process, only counted for access_results
+  struct access_counts *acc=NULL;
+  if(conf->accesslog==1){
+	  acc = access_counts_create(region_first(conf, idproc), region_blocks(conf), conf->access_bins);
+  }
 
- 	acessesarray[aux]=0;
 
+  //snapshots are streamed to their files every snap_interval
+  struct snap_series *series=NULL;
+  if(conf->printtofile==1){
+	  series = snap_open(conf, id);
   }
-  
-
-  //TODO here we must have a variable that only initiates snapshots if the user specified
-  //Also this must call realloc if the number of observations is higher thanthe size
-  //the snapshot time is 30 sec but could also be a parameter
-  stat.snap_throughput=malloc(sizeof(double)*1000);
-  stat.snap_latency=malloc(sizeof(double)*1000);
-  stat.snap_ops=malloc(sizeof(double)*1000);
-  stat.snap_time=malloc(sizeof(unsigned long long int)*1000);
 
+  //all times are in nanoseconds from the monotonic clock (see utils/timing)
   uint64_t begin_time, begin_size;
   uint64_t end_time, end_size;
   uint64_t ru_begin;
-  struct timeval tim;
 
 
-  gettimeofday(&tim, NULL);
-  begin_time=tim.tv_sec;
-  ru_begin = begin_time + conf->start;
+  begin_time=now_ns();
+  uint64_t replay_begin=begin_time;
+  ru_begin = begin_time + conf->start*1000000000ULL;
 
   if(conf->time_to_run > 0 ){
 	  //Get current time to mark the beggining of the benchmark and check
 	  //when it should end
-	  end_time = begin_time + conf->start + conf->time_to_run - conf->finish;
+	  end_time = begin_time + (conf->start + conf->time_to_run - conf->finish)*1000000000ULL;
   }else{
   	end_time=UINT64_MAX;
   }
@@ -183,12 +235,9 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
   	end_size=UINT64_MAX;
   }
 
-  //global timeval structure for nominal tests
-  struct timeval base;
-
   //variables for nominal tests
-  //getcurrent time and put in global variable base
-  gettimeofday(&base, NULL);
+  //current time is the base for measuring the elapsed time
+  uint64_t base=begin_time;
   //time elapsed (us) for all operations.
   //starts with value 1 because the value must be higher than 0.
   //the nominal rate will then adjust to the base value and the
@@ -197,6 +246,10 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 
   //while bench time has not ended or amount of data is not written
   while( begin_time < end_time && begin_size < end_size){
+	//workload schedule
+	if(update_phase(conf, info, &stat, begin_time)){
+		printf("Process %d: starting phase %d (%s)\n", procid_r, stat.phase, conf->phases[stat.phase].distfile);
+	}
 	Fault_Conf next_fault = next_fault_conf(finfo->faults, idproc, stat.tot_ops, time_elapsed);
    //for nominal testes only
    //number of operations performed for all processes
@@ -206,23 +259,49 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
    assert(ops_proc>=0);
    assert(time_elapsed>0);
    //IF the the test is peak or if it is NOMINAL and we are below the expected rate
-   if(conf->testtype==PEAK || ops_proc/time_elapsed<ratio){
+   //the timing of replayed requests is given by the trace
+   if(conf->testtype==PEAK || rr || ops_proc/time_elapsed<ratio){
 
 	 char* buf;
 	 uint64_t iooffset=0;
+	 //size of the request and number of blocks (dedup units) in it
+	 uint64_t reqsize;
+	 int optype=iotype;
+	 struct replay_op rop;
+	 if(rr){
+		 //the replay ends with the trace
+		 if(!replay_next(rr, conf, &rop)){
+			 break;
+		 }
+		 if(conf->replay_speed>0 && replay_wait(replay_begin+rop.due_ns)>1000000){
+			 replay_late++;
+		 }
+		 reqsize=rop.size;
+		 optype=rop.op;
+	 }else{
+		 reqsize=get_request_size(conf, &stat.rng);
+	 }
+	 uint64_t nblocks=reqsize/conf->block_size;
+	 uint64_t b;
+	 //reads verified online are done in the buffers of the verifier
+	 char* vbuf=NULL;
+	 if(ver && optype!=WRITE && !(next_fault && next_fault->operation & 1)){
+		 buf = vbuf = verifier_buffer(ver, reqsize);
+	 }
      //memory block
-	 if(conf->odirectf==1){
-		 buf = memalign(conf->block_size,conf->block_size);
+	 else if(conf->odirectf==1){
+		 buf = memalign(conf->block_size,reqsize);
 	 }else{
-		 buf = malloc(conf->block_size);
+		 buf = malloc(reqsize);
 	 }
 
 	 //If it is a write test then get the content to write and
 	 //populate buffer with the content to be written
-	 if(iotype==WRITE || (next_fault && next_fault->operation & 1)){
+	 if(optype==WRITE || (next_fault && next_fault->operation & 1)){
 
 	 	uint64_t idwrite=0;	 
-	 	struct block_info info_write;
+	 	//content of each block of the request
+	 	struct block_info info_write[nblocks];
 		//struct block_info info_write_mem;
 
 		//Used to save up memory by sharing pointers to faults and integrity check structure.
@@ -234,60 +313,60 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 		}*/
 		 
 
-	 	iooffset=write_request(buf,conf, info, &stat, idproc, &info_write);
-
-	 	idwrite=info_write.cont_id;
-		finfo_set_block_info(finfo, info_write, idproc);
-	 	//idwrite is the index of sum where the block belongs
-  		//put in stblock_info_dedup_getatistics this value ==1 to know when a duplicate is found
-  		//TODO this depends highly on the id generation and should be transparent
-  		if(conf->distout==1 || conf->fault_measure>0){
-    		if(idwrite<info->duplicated_blocks){
-      			info->statistics[idwrite]++;
-      			if(info->statistics[idwrite]>1){
-        			stat.dupl++;
-        			if(info->statistics[idwrite]>=info->topblock_dups){
-        				info->topblock=idwrite;
-        				info->topblock_dups=info->statistics[idwrite];
-        			}
-        			if(info->statistics[idwrite]<=info->botblock_dups){
-        				info->botblock=idwrite;
-        				info->botblock_dups=info->statistics[idwrite];
-        			}
-      			}
-      			else{
-        			stat.uni++;
-      			}
-
-            info->last_block_written.cont_id=idwrite;
-            info->last_block_written.procid=-1;
-            info->last_block_written.ts=-1;
-   			}
-   			else{
-   				stat.uni++;
-			    // uni referes to unique blocks meaning that
-			    // also counts 1 copy of each duplicated block
-			    // zerodups only refers to blocks with only one copy (no duplicates)
-			    stat.zerod++;
-			    if(conf->distout==1){
-			      *info->zerodups=*info->zerodups+1;
-			    }			
-   				
-   				info->last_unique_block.cont_id=info_write.cont_id;
-   				info->last_unique_block.procid=info_write.procid;
-   				info->last_unique_block.ts=info_write.ts;
-
-          info->last_block_written.cont_id=info_write.cont_id;
-          info->last_block_written.procid=info_write.procid;
-          info->last_block_written.ts=info_write.ts;
-   			}
-  		}
-
-	   acessesarray[iooffset/conf->block_size]++;
+	 	if(rr){
+	 		write_content(buf, nblocks, conf, info, &stat, idproc, info_write);
+	 		iooffset=rop.offset;
+	 	}else{
+	 		iooffset=write_request(buf,nblocks,conf, info, &stat, idproc, info_write);
+	 	}
+	 	stat.wreqs++;
+
+	 	for(b=0;b<nblocks;b++){
+
+		 	idwrite=info_write[b].cont_id;
+			finfo_set_block_info(finfo, info_write[b], idproc);
+		 	//idwrite is the index of sum where the block belongs
+	  		//put in stblock_info_dedup_getatistics this value ==1 to know when a duplicate is found
+	  		//TODO this depends highly on the id generation and should be transparent
+	  		if(conf->distout==1 || conf->fault_measure>0){
+	    		if(idwrite<info->duplicated_blocks){
+	    			//copies written by the population and by this process
+	    			uint64_t occurrences=count_duplicate(info, idwrite);
+	      			if(occurrences>1){
+	        			stat.dupl++;
+	        			if(occurrences>=info->topblock_dups){
+	        				info->topblock=idwrite;
+	        				info->topblock_dups=occurrences;
+	        			}
+	        			if(occurrences<=info->botblock_dups){
+	        				info->botblock=idwrite;
+	        				info->botblock_dups=occurrences;
+	        			}
+	      			}
+	      			else{
+	        			stat.uni++;
+	      			}
+
+	            info->last_block_written.cont_id=idwrite;
+	            info->last_block_written.procid=-1;
+	            info->last_block_written.ts=-1;
+	   			}
+	   			else{
+	   				//uni, zerod and zerodups were already counted by get_writecontent
+	   				info->last_unique_block.cont_id=info_write[b].cont_id;
+	   				info->last_unique_block.procid=info_write[b].procid;
+	   				info->last_unique_block.ts=info_write[b].ts;
+
+	          info->last_block_written.cont_id=info_write[b].cont_id;
+	          info->last_block_written.procid=info_write[b].procid;
+	          info->last_block_written.ts=info_write[b].ts;
+	   			}
+	  		}
+	 	}
+	   count_accesses(acc, iooffset/conf->block_size, nblocks);
      
        //get current time for calculating I/O op latency
-       gettimeofday(&tim, NULL);
-       uint64_t t1=tim.tv_sec*1000000+(tim.tv_usec);
+       uint64_t t1=now_ns();
 
 	  
 	   if(next_fault && next_fault->measure == NEXT_GEN && 
@@ -295,7 +374,7 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 		   inject_fault(next_fault, dedup_degree, conf->block_size, finfo, &fstats, idproc, iooffset);
 	   }
 
-       int res = pwrite(fd_test,buf,conf->block_size,iooffset);
+       int res = pwrite(fd_test,buf,reqsize,iooffset);
 
 	   if(next_fault && next_fault->measure != NEXT_GEN && 
 	   		(next_fault->operation & 1 || next_fault->operation == 0)){
@@ -313,21 +392,21 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
        }
 
 		int pos = (conf->rawdevice==1) ? 0 : idproc;
-       if(conf->integrity>=1){	
-			//info->content_tracker[pos][iooffset/conf->block_size] = info_write;
-       		info->content_tracker[pos][iooffset/conf->block_size].cont_id=info_write.cont_id;			
-       		info->content_tracker[pos][iooffset/conf->block_size].procid=info_write.procid;
-       		info->content_tracker[pos][iooffset/conf->block_size].ts=info_write.ts;
-			dedup_degree_add_block_info_write(dedup_degree, &info->content_tracker[pos][iooffset/conf->block_size]);
-			dedup_degree_add_offset_write(dedup_degree, iooffset);
+       //without tracker the static check regenerates the content (see replay_integrity)
+       for(b=0;b<nblocks;b++){
+			track_block(conf, info, pos, iooffset/conf->block_size+b, &info_write[b]);
+       }
+       for(b=0;b<nblocks && info->content_tracker;b++){
+			uint64_t blk=iooffset/conf->block_size+b;
+			dedup_degree_add_block_info_write(dedup_degree, &info->content_tracker[pos][blk]);
+			dedup_degree_add_offset_write(dedup_degree, blk*conf->block_size);
 			//dedup_degree_add_block(dedup_degree, &info->content_tracker[pos][iooffset/conf->block_size]);
 	   		//dedup_degree_add_offSet(dedup_degree, iooffset, true);
 
        }
        //latency calculation
-       gettimeofday(&tim, NULL);
-       uint64_t t2=tim.tv_sec*1000000+(tim.tv_usec);
-       uint64_t t2s = tim.tv_sec;
+       uint64_t t2=now_ns();
+       begin_time=t2;
        //t1snap must take value of t2 because we want to get the time when requets are processed
        stat.t1snap=t2;
 
@@ -349,49 +428,54 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
        
 	   if(conf->logfeature==1){
          //write in the log the operation latency
-		fprintf(fres,"%llu %llu\n", (long long unsigned int) t2-t1, (long long unsigned int)t2s);
+		fprintf(fres,"%llu %llu\n", (long long unsigned int) (t2-t1)/1000, (long long unsigned int) (t2+timing_epoch_offset_ns())/1000000000);
        }
+	   else if(conf->logfeature==2){
+		trace_op(tlog, t1, t2-t1, iooffset, nblocks, WRITE, info_write[0].cont_id, next_fault ? TRACE_FAULT_INJECTED : TRACE_FAULT_NONE);
+	   }
+	   if(mpage){
+		metrics_op(mpage, WRITE, reqsize, t2-t1);
+		metrics_set(mpage->faults, fstats.tot_faults_injected);
+	   }
 	}
 	//If it is a read benchmark
 	else {
 
-		iooffset=read_request(conf, &stat, idproc);
+		iooffset = (rr) ? rop.offset : read_request(nblocks, conf, &stat, idproc);
 		
-		acessesarray[iooffset/conf->block_size]++;
+		count_accesses(acc, iooffset/conf->block_size, nblocks);
 
 		//get current time for calculating I/O op latency
-		gettimeofday(&tim, NULL);
-		uint64_t t1=tim.tv_sec*1000000+(tim.tv_usec);
+		uint64_t t1=now_ns();
 
 		if(next_fault && next_fault->measure == NEXT_GEN && 
 			(next_fault->operation & 2 || next_fault->operation == 0)){
 		   inject_fault(next_fault, dedup_degree, conf->block_size, finfo, &fstats, idproc, iooffset);
 	   	}
 
-		uint64_t res = pread(fd_test,buf,conf->block_size,iooffset);
+		uint64_t res = pread(fd_test,buf,reqsize,iooffset);
 		int pos = (conf->rawdevice==1) ? 0 : idproc;
-		dedup_degree_add_block_info_read(dedup_degree, &info->content_tracker[pos][iooffset/conf->block_size]);
-		dedup_degree_add_offset_read(dedup_degree, iooffset);
+		for(b=0;b<nblocks && info->content_tracker;b++){
+			dedup_degree_add_block_info_read(dedup_degree, &info->content_tracker[pos][iooffset/conf->block_size+b]);
+			dedup_degree_add_offset_read(dedup_degree, iooffset+b*conf->block_size);
+		}
 
 		if(next_fault && next_fault->measure != NEXT_GEN && 
 			(next_fault->operation & 2 || next_fault->operation == 0)){
 		   inject_fault(next_fault, dedup_degree, conf->block_size, finfo, &fstats, idproc, iooffset);
 	   	}
 		//latency calculation
-		gettimeofday(&tim, NULL);
-		uint64_t t2=tim.tv_sec*1000000+(tim.tv_usec);
-		uint64_t t2s = tim.tv_sec;
+		uint64_t t2=now_ns();
+		begin_time=t2;
 
 		//t1snap must take value of t2 because we want to get the time when requets are processed
 		stat.t1snap=t2;
 
-		if(conf->integrity>=2){
-
-			integrity_errors+=compare_blocks(buf, info->content_tracker[pos][iooffset/conf->block_size], conf->block_size, fpi, 0);
-			
-       	}
+		if(vbuf){
+			integrity_errors+=verify_read(ver, info, pos, iooffset/conf->block_size, nblocks);
+		}
 
-		if(res != conf->block_size){
+		if(res != reqsize){
 			stat.misses_read++;
 		    printf("Error reading block %llu\n",(long long unsigned int)res);
 		}
@@ -411,26 +495,37 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 
 		if(conf->logfeature==1){
 		  //write in the log the operation latency
-		  fprintf(fres,"%llu %llu\n", (long long unsigned int) t2-t1, (long long unsigned int) t2s);
+		  fprintf(fres,"%llu %llu\n", (long long unsigned int) (t2-t1)/1000, (long long unsigned int) (t2+timing_epoch_offset_ns())/1000000000);
+		}
+		else if(conf->logfeature==2){
+		  //content expected at the block is only known when its writes are tracked
+		  uint64_t idread = tracked_content_id(conf, info, pos, iooffset/conf->block_size);
+		  trace_op(tlog, t1, t2-t1, iooffset, nblocks, READ, idread, next_fault ? TRACE_FAULT_INJECTED : TRACE_FAULT_NONE);
+		}
+		if(mpage){
+		  metrics_op(mpage, READ, reqsize, t2-t1);
+		  metrics_inc(mpage->misses_read, (res != reqsize) ? 1 : 0);
+		  metrics_set(mpage->faults, fstats.tot_faults_injected);
+		  metrics_set(mpage->integrity_errors, integrity_errors+((ver) ? verifier_errors(ver) : 0));
 		}
 		
      }
 
-	 free(buf);
+	 if(!vbuf){
+		 free(buf);
+	 }
 
 	//One more operation was performed
 	if(begin_time>=ru_begin){
 		 stat.tot_ops++;
 		 stat.snap_totops++;
+		 snap_counters_publish(&conf->counters[procid_r], &stat);
 	}
  
-		 if(stat.t1snap>=stat.last_snap_time+30*1e6){
+		 if(stat.t1snap>=stat.last_snap_time+conf->snap_interval){
 
-		 		   if(begin_time >= ru_begin){
-					   stat.snap_throughput[stat.iter_snap]=(stat.snap_totops/((stat.t1snap-stat.last_snap_time)/1.0e6));
-					   stat.snap_latency[stat.iter_snap]=(stat.snap_lat/stat.snap_totops)/1000;
-					   stat.snap_ops[stat.iter_snap]=(stat.snap_totops);
-					   stat.snap_time[stat.iter_snap]=stat.t1snap;
+		 		   if(begin_time >= ru_begin && series){
+					   snap_write(series, &stat);
 				   }
 		    	   stat.iter_snap++;
 				   stat.snap_lat=0;
@@ -438,18 +533,22 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 				   stat.last_snap_time=stat.t1snap;
 		 }
 
+		 stat.phase_ops++;
+
+		 //number_ops is given in blocks
 		 if(conf->number_ops>0){
-			   begin_size++;
+			   begin_size+=nblocks;
 		 }
 	} else {
        //if the test is nominal and the I/O throughput is higher than the
 	   //expected ration sleep for a while
 	   idle(4000);
+	   begin_time=now_ns();
     }
 
 
    //add to the total time the time elapsed with this operation
-   time_elapsed+=lap_time(&base);
+   time_elapsed+=lap_time(&base, begin_time);
 
    //DEBUG;
    if((stat.tot_ops%100000)==0){
@@ -459,10 +558,6 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
    if(stat.misses_read%10000==0 && stat.misses_read>0 ){
 	   printf("Process %d has reached %llu misses\n",procid_r, (long long unsigned int) stat.misses_read);
    }
-
-   //update current time
-   gettimeofday(&tim, NULL);
-   begin_time=tim.tv_sec;
   }
 //dedup_degree_print_sorted_array(dedup_degree);
 //  dedup_degree_print_block_info_write(dedup_degree);
@@ -470,16 +565,29 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
   if(conf->logfeature==1){
 	  fclose(fres);
   }
+  else if(conf->logfeature==2){
+	  trace_close(tlog);
+  }
+  if(mpage){
+	  metrics_end(mpage);
+  }
+  if(rr){
+	  if(replay_late>0){
+		  printf("Process %d: %llu replayed requests were issued more than 1 ms late\n", procid_r, (unsigned long long int) replay_late);
+	  }
+	  replay_close(rr);
+  }
   close(fd_test);
 
+  //the duplicates written by the process are added to the shared counters only once
+  merge_dup_shard(info);
+  __atomic_store_n(&conf->counters[procid_r].wreqs, stat.wreqs, __ATOMIC_RELAXED);
+
 
   if(stat.t1snap>stat.last_snap_time){
 	  //Write last snap because ther may be some operations missing
-  	  if(begin_time>=ru_begin){
-		  stat.snap_throughput[stat.iter_snap]=(stat.snap_totops/((stat.t1snap-stat.last_snap_time)/1.0e6));
-		  stat.snap_latency[stat.iter_snap]=(stat.snap_lat/stat.snap_totops)/1000;
-		  stat.snap_ops[stat.iter_snap]=(stat.snap_totops);
-		  stat.snap_time[stat.iter_snap]=stat.t1snap;
+  	  if(begin_time>=ru_begin && series){
+		  snap_write(series, &stat);
 	  }
 	  
 	  stat.iter_snap++;
@@ -490,8 +598,8 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 
   //calculate average latency milisseconds
   if(begin_time >= ru_begin){
-	  stat.latency=(stat.latency/stat.tot_ops)/1000.0;
-	  stat.throughput=(stat.tot_ops/((stat.endio-stat.beginio)/1.0e6));
+	  stat.latency=(stat.latency/stat.tot_ops)/1.0e6;
+	  stat.throughput=(stat.tot_ops/((stat.endio-stat.beginio)/1.0e9));
   }
 
   if(conf->distout==1){
@@ -518,20 +626,26 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
   }
 
   if(conf->printtofile==1){
-	  int r = write_latency_throughput_snaps(&stat, conf, id);
-	  if(r == 1)
-		  printf("Couldnt create latency and throughput files.");
+	  snap_close(series, conf, id);
+  }
+
+  uint64_t cache_hits, cache_misses;
+  free_content_cache(&cache_hits, &cache_misses);
+  if(conf->content_cache>0 && cache_hits+cache_misses>0){
+	  printf("Process %d: content cache hits %.2f%% (%llu of %llu duplicated blocks)\n", procid_r, (cache_hits*100.0)/(cache_hits+cache_misses),
+		(unsigned long long int) cache_hits, (unsigned long long int) (cache_hits+cache_misses));
   }
   
   if(conf->accesslog==1){
-	  int r = write_access_data(acessesarray, conf, id);
+	  int r = write_access_data(acc, conf, id);
 	  if(r == 1){
 		  printf("Couldnt create access files.");
 	  }
   }
  
 
-  if(conf->integrity>=2 && iotype==READ){
+  if(fpi){
+  	integrity_errors+=verifier_stop(ver);
   	if(integrity_errors>0){
   		printf("Found %d integrity errors see %s file for more details\n", integrity_errors, ifilename);
   	}else{
@@ -576,7 +690,7 @@ void process_run(int idproc, int nproc, double ratio, int iotype, struct user_co
 	}
 
   //init acesses array
-  free(acessesarray);
+  access_counts_destroy(acc);
 }
 
 
@@ -595,7 +709,10 @@ void launch_benchmark(struct user_confs* conf, struct duplicates_info *info, str
 		findex = 0;
 	}
 
-  init_rand(conf->seed);
+  conf->counters=snap_counters_create(conf->nprocs);
+  if(conf->metricsf==1){
+    conf->metrics=metrics_create(conf->nprocs);
+  }
   if(conf->mixedIO==1){
     conf->nr_proc_w=conf->nprocs/2;
     nprocinit=conf->nprocs/2;
@@ -634,17 +751,40 @@ void launch_benchmark(struct user_confs* conf, struct duplicates_info *info, str
 	  }
 	}
 
+	//the endpoint is served by a thread of the parent process while the children run
+	struct metrics_server *mserver=NULL;
+	if(conf->metricsf==1){
+		mserver=metrics_serve(conf->metrics, conf->nprocs, conf->metricsendpoint);
+	}
+
 	/* Wait for children to exit. */
-	int status;
-	pid_t pid;
-	int nprocstowait=conf->nprocs;
-	while (nprocstowait > 0) {
-	  pid = wait(&status);
-	  printf("Terminating process with PID %ld exited with status 0x%x.\n", (long)pid, status);
-	  --nprocstowait;
+	if(conf->printtofile==1){
+		//aggregate the snapshots of all processes while they run
+		snap_coordinator(conf, conf->counters, conf->nprocs);
+	}else{
+		int status;
+		pid_t pid;
+		int nprocstowait=conf->nprocs;
+		while (nprocstowait > 0) {
+		  pid = wait(&status);
+		  printf("Terminating process with PID %ld exited with status 0x%x.\n", (long)pid, status);
+		  --nprocstowait;
+		}
 	}
 
 	free(pids);
+	if(replay_integrity(conf)){
+		//write requests of each process, replayed by the static integrity check
+		conf->wreqs=malloc(sizeof(uint64_t)*conf->nprocs);
+		for(i=0;i<conf->nprocs;i++){
+			conf->wreqs[i]=conf->counters[i].wreqs;
+		}
+	}
+	snap_counters_destroy(conf->counters, conf->nprocs);
+	if(conf->metricsf==1){
+		metrics_stop(mserver);
+		metrics_destroy(conf->metrics, conf->nprocs);
+	}
 
 	if(conf->integrity==1 || conf->integrity==3){
 		check_integrity(conf, info);
@@ -759,10 +899,30 @@ static int config_handler(void* config, const char* section, const char* name, c
 		
 		printf("Output of DEDISbench will be printed to './results/%s'\n", conf->printfile);
 	}
+	else if(MATCH("results","snap_interval")){
+		//milliseconds
+		conf->snap_interval = atoll(value)*1000000ULL;
+		if(conf->snap_interval<SNAP_INTERVAL_MIN){
+			printf("Snapshot interval must be at least %llu ms, using %llu ms\n", SNAP_INTERVAL_MIN/1000000, SNAP_INTERVAL_MIN/1000000);
+			conf->snap_interval = SNAP_INTERVAL_MIN;
+		}
+	}
+	else if(MATCH("results","metrics")){
+		//an empty value would bind a random TCP port
+		if(strlen(value)==0){
+			printf("metrics must be a TCP port or the path of a unix socket\n");
+			exit(0);
+		}
+		conf->metricsf = 1;
+		strcpy(conf->metricsendpoint,value);
+	}
 	else if(MATCH("results","access_results")){
 		conf->accesslog = 1;
 		strcpy(conf->accessfilelog,value);
 		printf("Access log will be printed to '%s'\n", conf->accessfilelog);
+	}
+	else if(MATCH("results","access_bins")){
+		conf->access_bins = atoll(value);
 	} else if(MATCH("results", "faults_results")){
 		conf->outputfaults = 1;
 		strcpy(conf->faultsoutputfile, value);
@@ -808,20 +968,30 @@ static int config_handler(void* config, const char* section, const char* name, c
 	else if(MATCH("structural", "cleantemp")){
 		conf->destroypfile = atoi(value);
 	}
-	else if(MATCH("execution", "logging")){
+	else if((MATCH("execution", "logging")) || (MATCH("results", "logging"))){
 		conf->logfeature = atoi(value);
 	}
 	else if(MATCH("execution", "access_type")){
-		// 0 - sequential | 1 - Rand uniform | 2 - NURand
-		int arg = atoi(value);
-		switch(arg){
-			case 0: conf->accesstype = SEQUENTIAL; break;
-			case 1: conf->accesstype = UNIFORM; break;
-			case 2: conf->accesstype = TPCC; break;
-			default:
-				perror("Unknown type of pattern acess for I/O operations");
+		// 0 - sequential | 1 - Rand uniform | 2 - NURand | 3 - zipfian | 4 - hot set | 5 - streams
+		int arg = parse_access_type(value);
+		if(arg<0){
+			perror("Unknown type of pattern acess for I/O operations");
+		}else{
+			conf->accesstype = arg;
 		}
 	}
+	else if(MATCH("execution", "zipf_theta")){
+		conf->zipf_theta = atof(value);
+	}
+	else if(MATCH("execution", "hotset")){
+		strcpy(conf->hotset,value);
+	}
+	else if(MATCH("execution", "streams")){
+		conf->nstreams = atoi(value);
+	}
+	else if(MATCH("execution", "stream_stride")){
+		conf->stream_stride = atoll(value);
+	}
 	else if(MATCH("execution", "nprocs")){
 		int n = atoi(value);
 		if(n==1 && conf->mixedIO == 1){
@@ -840,19 +1010,90 @@ static int config_handler(void* config, const char* section, const char* name, c
 		conf->rawdevice = 1;
 		strcpy(conf->rawpath,value);
 	}
+	else if(MATCH("execution", "region_align")){
+		conf->region_align = parse_size((char *) value);
+	}
+	else if(MATCH("execution", "region_overlap")){
+		conf->region_overlap = (strcmp(value, "all")==0) ? REGION_SHARED : atoi(value);
+	}
 	else if(MATCH("execution", "integrity")){
 		conf->integrity = atoi(value);
 		strcpy(conf->integrityfile,value);
 	}
+	else if(MATCH("execution", "integrity_tracker")){
+		conf->tracker = atoi(value);
+	}
+	else if(MATCH("execution", "tracker_file")){
+		strcpy(conf->trackerfile,value);
+	}
+	else if(MATCH("execution", "integrity_threads")){
+		conf->integrity_threads = atoi(value);
+	}
 	else if(MATCH("execution", "blocksize")){
 		conf->block_size = atof(value);
 	}
+	else if(MATCH("execution", "compressibility")){
+		int arg = atoi(value);
+		if(arg<0 || arg>100){
+			printf("compressibility must be a percentage between 0 and 100\n");
+			exit(0);
+		}
+		conf->compressibility = arg;
+	}
+	else if(MATCH("execution", "entropy")){
+		int arg = atoi(value);
+		if(arg<1 || arg>8){
+			printf("entropy must be between 1 and 8 bits per byte\n");
+			exit(0);
+		}
+		conf->entropy = arg;
+	}
+	else if(MATCH("execution", "content_cache")){
+		//MB
+		conf->content_cache = atoll(value)*1024*1024;
+	}
+	else if(phase_config(conf, section, name, value)){
+		//[phase<N>] sections of the workload schedule
+	}
+	else if(MATCH("replay", "tracefile")){
+		strcpy(conf->replayfile,value);
+		conf->replay=1;
+	}
+	else if(MATCH("replay", "speed")){
+		conf->replay_speed = atof(value);
+	}
+	else if(MATCH("execution", "deterministic")){
+		conf->deterministic = atoi(value);
+	}
+	else if(MATCH("execution", "dup_runlength")){
+		strcpy(conf->runlength,value);
+	}
+	else if(MATCH("execution", "bssplit")){
+		//parsed once the block size is known
+		strcpy(conf->bssplit,value);
+	}
+	else if(MATCH("execution", "clock")){
+		// 0 - TSC if invariant, otherwise monotonic | 1 - monotonic
+		int arg = atoi(value);
+		switch(arg){
+			case 0: conf->clocktype = CLOCK_AUTO; break;
+			case 1: conf->clocktype = CLOCK_MONO; break;
+			default:
+				perror("Unknown type of clock for measuring I/O operations");
+		}
+	}
 	else if(MATCH("execution", "seed")){
 		conf->seed = atof(value);
 	}
 	else if(MATCH("execution", "populate")){
 		conf->populate = atoi(value);
 	}
+	else if(MATCH("execution", "populate_threads")){
+		conf->populate_threads = atoi(value);
+	}
+	else if(MATCH("execution", "population_cache")){
+		strcpy(conf->popcache,value);
+	}
 	else if(MATCH("execution", "sync")){
 		int arg = atoi(value);
 		switch(arg){
@@ -905,13 +1146,18 @@ int main(int argc, char *argv[]){
 	struct user_confs conf = {.destroypfile = 1, .start=0, .finish=0, .accesstype = TPCC, .iotype = -1, .testtype = -1,
 	.ratio = -1, .ratiow = -1, .ratior = -1, .nprocs = 4, .filesize = 2048LLU,
 	.block_size = 4096LL, .populate=-1, .time_to_run=0, .number_ops=0, 
-	.usingfaults=0, .outputfaults=0, .outputdedup = 0, .outputoffsets = 0};
+	.usingfaults=0, .outputfaults=0, .outputdedup = 0, .outputoffsets = 0, .snap_interval = SNAP_INTERVAL_DEFAULT,
+	.compressibility = CONTENT_LEGACY, .entropy = 8, .zipf_theta = 0.99, .hot_perc = 10, .hot_access = 90, .nstreams = 4, .replay_speed = 1.0,
+	.access_bins = ACCESS_BINS};
 	conf.seed=tim.tv_sec*1000000+(tim.tv_usec);
 	bzero(conf.tempfilespath,PATH_SIZE);
 	bzero(conf.printfile,PATH_SIZE);
 	bzero(conf.accessfilelog,PATH_SIZE);
 	bzero(conf.rawpath,PATH_SIZE);
 	bzero(conf.distfile,PATH_SIZE);
+	bzero(conf.replayfile,PATH_SIZE);
+	bzero(conf.trackerfile,PATH_SIZE);
+	bzero(conf.popcache,PATH_SIZE);
 	bzero(conf.outputfile,PATH_SIZE);
 	bzero(conf.faultsconfigfile, PATH_SIZE);
 	bzero(conf.faultsoutputfile, PATH_SIZE);
@@ -1002,6 +1248,10 @@ int main(int argc, char *argv[]){
 		printf("Couldn't load default configuration file 'defconf.ini'\n");
 	}
 
+	//the operations of a replayed trace are given by the trace
+	if(conf.replay==1 && conf.iotype==-1 && conf.mixedIO==0){
+		conf.iotype=WRITE;
+	}
 	//test if iotype is defined
 	if(conf.iotype!=WRITE && conf.iotype!=READ && conf.mixedIO==0){
 		printf("missing -w or -r\n\n");
@@ -1015,7 +1265,7 @@ int main(int argc, char *argv[]){
 		exit(0);
 	}
 	//test if testype is defined
-	if(conf.number_ops<=0 && conf.time_to_run<=0){
+	if(conf.number_ops<=0 && conf.time_to_run<=0 && conf.replay==0){
 			printf("missing -t or -s<value> with value higher than 0 \n\n");
 			usage();
 			exit(0);
@@ -1040,6 +1290,17 @@ int main(int argc, char *argv[]){
 		usage();
 		exit(0);
 	}
+	//each block starts with a header that identifies its content
+	if(conf.block_size<sizeof(struct block_header)){
+		printf("block size value must be at least %d bytes\n", (int) sizeof(struct block_header));
+		usage();
+		exit(0);
+	}
+
+	if(init_request_sizes(&conf)<0 || init_runlengths(&conf)<0 || check_phases(&conf)<0 || init_access_patterns(&conf)<0 || check_replay(&conf)<0 || check_tracker(&conf)<0 || check_popcache(&conf)<0){
+		usage();
+		exit(0);
+	}
 
 	if(conf.nr_faults>0 && conf.iotype == READ && conf.populate!=REPOP){
      	printf("Fault injection for read tests is only available with realistic population: option populate=1\n");
@@ -1070,6 +1331,17 @@ int main(int argc, char *argv[]){
 
     //total blocks to be addressed at file
     conf.totblocks = conf.filesize/conf.block_size;
+    if(init_regions(&conf)<0){
+    	usage();
+    	exit(0);
+    }
+    //requests never go beyond the file or the region of the process
+    if(conf.max_request_size>region_blocks(&conf)*conf.block_size){
+    	printf("bssplit request size %llu is larger than the %llu bytes addressed by each process\n",
+    		(unsigned long long int) conf.max_request_size, (unsigned long long int) (region_blocks(&conf)*conf.block_size));
+    	usage();
+    	exit(0);
+    }
 
     //convert time_to_run to seconds
     if(conf.time_to_run > 0)
@@ -1079,6 +1351,9 @@ int main(int argc, char *argv[]){
     	conf.number_ops=(conf.number_ops*1024*1024)/conf.block_size;
 
 
+    //calibrate the clock before forking so that all processes share it
+    init_timing(conf.clocktype);
+
     //check if a distribution file was given as parameter
 	char *fname = DFILE;
     if(conf.distf==1){
@@ -1087,12 +1362,12 @@ int main(int argc, char *argv[]){
 
 	//get global information about duplicate and unique blocks
 	printf("loading duplicates distribution %s...\n",fname);
-	get_distribution_stats(&info, fname);
+	load_distribution(&info, fname);
+	//the distributions of the phases are used after the population
+	load_phases(&conf, &info);
 
 	if(conf.distout==1 || conf.integrity>=1 || conf.fault_measure>0){
 		loadmmap(mem,&sharedmem_size,&fd_shared, &info, &conf);
-	}else{
-		loadmem(&info);
 	}
 
 	//Loads the fault configuration file if the filepath is specified in the user's configuration file
@@ -1106,17 +1381,22 @@ int main(int argc, char *argv[]){
 	  }
   	}
 
-	//load duplicate array for using in the benchmark
-	load_duplicates(&info,fname);
-
 	//printf("distinct blocks %llu number unique blocks %llu number duplicates %llu\n",(long long unsigned int)total_blocks, (long long unsigned int)unique_blocks,(long long unsigned int)duplicated_blocks);
-	load_cumulativedist(&info, conf.distout);
+	//O(1) sampler of content ids
+	load_alias_table(&info);
+
+	//blocks written by the population and the benchmark processes
+	init_content(conf.compressibility, conf.entropy);
+	if(conf.compressibility!=CONTENT_LEGACY){
+		printf("Block content: %d%% compressible, %d bits of entropy per byte\n", conf.compressibility, conf.entropy);
+	}
 
 
     //writes can be performed over a populated file (populate=1)
     //this functionality can be disabled if the files are already populated (populate=0)
     //Or we can verify if the files already exist and ask?
-    if((conf.iotype==READ && conf.populate<0) || (conf.mixedIO==1 && conf.populate<0) || (conf.populate>0)){
+    //reads of a replayed trace also expect populated files
+    if(((conf.iotype==READ || conf.mixedIO==1 || conf.replay==1) && conf.populate<0) || (conf.populate>0)){
     	populate(&conf, &info);
     }
 
@@ -15,6 +15,7 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include "utils/db/berk.h"
+#include "benchcore/duplicates/distfile.h"
 
 //max path size of a folder/file
 #define MAXSIZEP 10000
@@ -367,10 +368,31 @@ void help(void){
 	printf(" -z<value>\t(Path for the folder where duplicates databases are created default: ./gendbs/duplicatedb/)\n");
 	printf(" -b<value>\t( Size of blocks to analyse in bytes eg: -b1024,4096,8192 default: -b4096\n");
 	printf(" -k\t\t(keep databases generated by a previous execution)\n");
+	printf(" -c<value>\t(Convert the distribution file <value> into a precompiled one (<value>.bin) that DEDISbench loads faster)\n");
 	exit (8);
 
 }
 
+//writes the precompiled version (<fname>.bin) of the distribution file fname
+static int compile_distribution(char *fname){
+
+	struct dist_table t;
+	char binname[MAXSIZEP];
+
+	if(read_distribution(fname, &t)<0){
+		return -1;
+	}
+
+	snprintf(binname, sizeof(binname), "%s.bin", fname);
+	int ret = write_distribution(binname, &t);
+	if(ret==0){
+		printf("precompiled distribution written to %s\n", binname);
+	}
+
+	free_distribution(&t);
+	return ret;
+}
+
 // the recursive nature of this function could be its demise when dealing
 // with deep directories
 static int remove_dir(const char* path){
@@ -471,6 +493,9 @@ int main (int argc, char *argv[]){
 			case 'k':
 				removedb=0;
 				break;
+			case 'c':
+				exit(compile_distribution(&argv[1][2])==0 ? 0 : 1);
+				break;
 			case 'h':
 				help();
 				break;
@@ -639,6 +664,7 @@ int main (int argc, char *argv[]){
 			
 			print_elements_print(dbprinter[aux], envprinter[aux],fpp, fpcumul);
 			fclose(fpp);
+			compile_distribution(outputfilename);
 		
 			fclose(fpcumul);			
 			strcpy(plotfilename, outputfilename);
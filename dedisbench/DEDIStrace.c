@@ -0,0 +1,234 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written: J. Paulo
+ */
+
+//Converts the binary traces written by DEDISbench (logging=2) into the
+//text formats produced by the benchmark, and text block I/O traces into
+//the binary format replayed by DEDISbench ([replay] section)
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "io/trace.h"
+#include "benchcore/replay/replay.h"
+
+//output formats
+#define FMT_LOG 1
+#define FMT_FULL 2
+#define FMT_SNAPLAT 3
+#define FMT_SNAPTHR 4
+
+
+void help(void){
+	printf(" Help:\n\n");
+	printf(" -i<trace file>\t\t(Binary trace written by DEDISbench, eg: results/tracep0)\n");
+	printf(" -o<output file>\t(Output file, default: stdout)\n");
+	printf(" -l\t\t\t(Output the logging=1 format: <latency us> <time s> (default))\n");
+	printf(" -c\t\t\t(Output every field: <start ns> <latency ns> <offset> <op> <content id> <fault>)\n");
+	printf(" -L<seconds>\t\t(Output latency snapshots for intervals of <seconds>: <time us> <latency ms> <ops>)\n");
+	printf(" -T<seconds>\t\t(Output throughput snapshots for intervals of <seconds>: <time us> <blocks/s> <ops>)\n");
+	printf(" -b<text trace>\t\t(Convert a text block I/O trace <offset>,<size>,<op>,<timestamp> into the binary replay format, requires -o)\n");
+	printf(" -h\t\t\t(Help)\n");
+	exit (8);
+}
+
+//prints the snapshot of interval [snap_begin, snap_end[ (ns)
+static void print_snap(FILE* out, int fmt, uint64_t snap_begin, uint64_t snap_end, uint64_t ops, uint64_t lat){
+
+	if(ops==0){
+		return;
+	}
+
+	if(fmt==FMT_SNAPLAT){
+		fprintf(out, "%llu %.3f %f\n", (unsigned long long int) snap_end/1000, (lat/(double)ops)/1.0e6, (double) ops);
+	}else{
+		fprintf(out, "%llu %.3f %f\n", (unsigned long long int) snap_end/1000, ops/((snap_end-snap_begin)/1.0e9), (double) ops);
+	}
+}
+
+int convert_trace(char* fname, FILE* out, int fmt, uint64_t interval_ns){
+
+	int fd = open(fname, O_RDONLY);
+	if(fd==-1){
+		perror("Error opening trace file");
+		return 1;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st)!=0 || st.st_size<sizeof(struct trace_header)){
+		printf("%s is not a DEDISbench trace\n", fname);
+		close(fd);
+		return 1;
+	}
+
+	char* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if(map==MAP_FAILED){
+		perror("Error mmapping trace file");
+		close(fd);
+		return 1;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	struct trace_header *hdr = (struct trace_header *) map;
+	if(memcmp(hdr->magic, TRACE_MAGIC, sizeof(hdr->magic))!=0 || hdr->version!=TRACE_VERSION || hdr->record_size!=sizeof(struct trace_record)){
+		printf("%s is not a DEDISbench trace or was written by an incompatible version\n", fname);
+		munmap(map, st.st_size);
+		close(fd);
+		return 1;
+	}
+
+	//traces of processes that did not finish have nrecords==0, use the file size instead
+	uint64_t nrecords = (st.st_size-sizeof(struct trace_header))/sizeof(struct trace_record);
+	if(hdr->nrecords>0 && hdr->nrecords<nrecords){
+		nrecords=hdr->nrecords;
+	}
+
+	struct trace_record *recs = (struct trace_record *) (map+sizeof(struct trace_header));
+	uint64_t i;
+
+	uint64_t snap_begin=0, snap_ops=0, snap_lat=0;
+
+	for(i=0;i<nrecords;i++){
+		struct trace_record *r = &recs[i];
+		//wall clock time when the operation ended
+		uint64_t end_ns = hdr->epoch_offset_ns+r->start_ns+r->latency_ns;
+
+		switch(fmt){
+			case FMT_LOG:
+				fprintf(out, "%llu %llu\n", (unsigned long long int) r->latency_ns/1000, (unsigned long long int) end_ns/1000000000);
+				break;
+			case FMT_FULL:
+				fprintf(out, "%llu %llu %llu %u %s %llu %d\n", (unsigned long long int) hdr->epoch_offset_ns+r->start_ns,
+					(unsigned long long int) r->latency_ns, (unsigned long long int) r->offset, r->nblocks, (r->op==WRITE) ? "w" : "r",
+					(unsigned long long int) r->cont_id, r->fault);
+				break;
+			default:
+				if(i==0){
+					snap_begin=end_ns;
+				}
+				if(end_ns>=snap_begin+interval_ns){
+					print_snap(out, fmt, snap_begin, end_ns, snap_ops, snap_lat);
+					snap_begin=end_ns;
+					snap_ops=0;
+					snap_lat=0;
+				}
+				snap_ops++;
+				snap_lat+=r->latency_ns;
+				break;
+		}
+	}
+
+	if(fmt==FMT_SNAPLAT || fmt==FMT_SNAPTHR){
+		if(nrecords>0){
+			struct trace_record *r = &recs[nrecords-1];
+			print_snap(out, fmt, snap_begin, hdr->epoch_offset_ns+r->start_ns+r->latency_ns, snap_ops, snap_lat);
+		}
+	}
+
+	munmap(map, st.st_size);
+	close(fd);
+
+	return 0;
+}
+
+int main (int argc, char *argv[]){
+
+	char tracefile[PATH_SIZE];
+	char outputfile[PATH_SIZE];
+	char replayfile[PATH_SIZE];
+	int fmt=FMT_LOG;
+	uint64_t interval_ns=30*1e9;
+
+	bzero(tracefile, PATH_SIZE);
+	bzero(outputfile, PATH_SIZE);
+	bzero(replayfile, PATH_SIZE);
+
+	while ((argc > 1) && (argv[1][0] == '-'))
+	{
+		switch (argv[1][1])
+		{
+			case 'i':
+				strcpy(tracefile,&argv[1][2]);
+				break;
+			case 'o':
+				strcpy(outputfile,&argv[1][2]);
+				break;
+			case 'l':
+				fmt=FMT_LOG;
+				break;
+			case 'c':
+				fmt=FMT_FULL;
+				break;
+			case 'L':
+				fmt=FMT_SNAPLAT;
+				interval_ns=atof(&argv[1][2])*1e9;
+				break;
+			case 'T':
+				fmt=FMT_SNAPTHR;
+				interval_ns=atof(&argv[1][2])*1e9;
+				break;
+			case 'b':
+				strcpy(replayfile,&argv[1][2]);
+				break;
+			case 'h':
+				help();
+				break;
+			default:
+				printf("Wrong Argument: %s\n", argv[1]);
+				help();
+				break;
+		}
+
+		++argv;
+		--argc;
+	}
+
+	if(strlen(replayfile)>0){
+		if(strlen(outputfile)==0){
+			printf("missing -o<binary trace>\n\n");
+			help();
+		}
+		int64_t n = compile_replay(replayfile, outputfile);
+		if(n<0){
+			return 1;
+		}
+		printf("%lld requests written to %s\n", (long long int) n, outputfile);
+		return 0;
+	}
+
+	if(strlen(tracefile)==0){
+		printf("missing -i<trace file>\n\n");
+		help();
+	}
+
+	if((fmt==FMT_SNAPLAT || fmt==FMT_SNAPTHR) && interval_ns==0){
+		printf("snapshot interval must be higher than 0\n\n");
+		help();
+	}
+
+	FILE* out=stdout;
+	if(strlen(outputfile)>0){
+		out=fopen(outputfile,"w");
+		if(!out){
+			perror("Error opening output file");
+			exit(1);
+		}
+	}
+
+	int ret = convert_trace(tracefile, out, fmt, interval_ns);
+
+	if(out!=stdout){
+		fclose(out);
+	}
+
+	return ret;
+}
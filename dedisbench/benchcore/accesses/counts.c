@@ -0,0 +1,153 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "counts.h"
+
+
+struct access_counts* access_counts_create(uint64_t first, uint64_t nblocks, uint64_t nbins){
+
+	struct access_counts *ac = calloc(1, sizeof(struct access_counts));
+	if(!ac){
+		perror("Error allocating access counters");
+		exit(EXIT_FAILURE);
+	}
+
+	ac->first=first;
+	ac->nblocks=nblocks;
+	ac->npages=(nblocks+ACCESS_PAGE_BLOCKS-1)/ACCESS_PAGE_BLOCKS;
+	ac->pages=calloc(ac->npages, sizeof(uint16_t *));
+
+	if(nbins==0 || nbins>nblocks){
+		nbins = (nblocks>0) ? nblocks : 1;
+	}
+	ac->bin_blocks=(nblocks+nbins-1)/nbins;
+	ac->nbins=(nblocks+ac->bin_blocks-1)/ac->bin_blocks;
+	ac->bin_accesses=calloc(ac->nbins, sizeof(uint64_t));
+	ac->bin_touched=calloc(ac->nbins, sizeof(uint64_t));
+
+	if(!ac->pages || !ac->bin_accesses || !ac->bin_touched){
+		perror("Error allocating access counters");
+		exit(EXIT_FAILURE);
+	}
+
+	return ac;
+}
+
+static struct access_overflow* overflow_entry(struct access_counts *ac, uint64_t i){
+
+	uint64_t mask=ac->overflow_size-1;
+	//fibonacci hashing, the high bits of the product spread consecutive blocks over the
+	//table (the size is a power of 2)
+	uint64_t h=((i+1)*0x9E3779B97F4A7C15ULL)>>(64-__builtin_ctzll(ac->overflow_size));
+
+	while(ac->overflow[h].key!=0 && ac->overflow[h].key!=i+1){
+		h=(h+1)&mask;
+	}
+	return &ac->overflow[h];
+}
+
+static void overflow_grow(struct access_counts *ac){
+
+	struct access_overflow *old=ac->overflow;
+	uint64_t old_size=ac->overflow_size, j;
+
+	ac->overflow_size = (old_size>0) ? old_size*2 : 64;
+	ac->overflow=calloc(ac->overflow_size, sizeof(struct access_overflow));
+	if(!ac->overflow){
+		perror("Error allocating access counters overflow");
+		exit(EXIT_FAILURE);
+	}
+	for(j=0;j<old_size;j++){
+		if(old[j].key!=0){
+			*overflow_entry(ac, old[j].key-1)=old[j];
+		}
+	}
+	free(old);
+}
+
+//accesses of a block whose counter saturated
+static void count_overflow(struct access_counts *ac, uint64_t i){
+
+	if(2*(ac->overflow_used+1)>ac->overflow_size){
+		overflow_grow(ac);
+	}
+	struct access_overflow *e=overflow_entry(ac, i);
+	if(e->key==0){
+		e->key=i+1;
+		ac->overflow_used++;
+	}
+	e->count++;
+}
+
+void count_accesses(struct access_counts *ac, uint64_t blk, uint64_t n){
+
+	uint64_t b;
+
+	if(!ac){
+		return;
+	}
+
+	for(b=0;b<n;b++){
+		uint64_t i=blk+b-ac->first;
+		//requests never go beyond the region of the process
+		if(i>=ac->nblocks){
+			continue;
+		}
+
+		uint16_t *page=ac->pages[i/ACCESS_PAGE_BLOCKS];
+		if(!page){
+			page=calloc(ACCESS_PAGE_BLOCKS, sizeof(uint16_t));
+			if(!page){
+				perror("Error allocating access counters");
+				exit(EXIT_FAILURE);
+			}
+			ac->pages[i/ACCESS_PAGE_BLOCKS]=page;
+		}
+
+		uint16_t *c=&page[i%ACCESS_PAGE_BLOCKS];
+		if(*c==0){
+			ac->bin_touched[i/ac->bin_blocks]++;
+		}
+		if(*c<UINT16_MAX){
+			(*c)++;
+		}else{
+			count_overflow(ac, i);
+		}
+		ac->bin_accesses[i/ac->bin_blocks]++;
+	}
+}
+
+uint64_t access_count(struct access_counts *ac, uint64_t i){
+
+	uint16_t *page=ac->pages[i/ACCESS_PAGE_BLOCKS];
+	if(!page){
+		return 0;
+	}
+
+	uint64_t count=page[i%ACCESS_PAGE_BLOCKS];
+	if(count==UINT16_MAX && ac->overflow_used>0){
+		count+=overflow_entry(ac, i)->count;
+	}
+	return count;
+}
+
+void access_counts_destroy(struct access_counts *ac){
+
+	uint64_t p;
+
+	if(!ac){
+		return;
+	}
+	for(p=0;p<ac->npages;p++){
+		free(ac->pages[p]);
+	}
+	free(ac->pages);
+	free(ac->overflow);
+	free(ac->bin_accesses);
+	free(ac->bin_touched);
+	free(ac);
+}
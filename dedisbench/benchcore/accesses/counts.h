@@ -0,0 +1,61 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef COUNTS_H
+#define COUNTS_H
+
+#include <stdint.h>
+
+//Accesses to each block of the file (or of the device region) of a process (access_results)
+//Blocks have 16 bit saturating counters, allocated in pages when a block of the page is first
+//accessed, the accesses of the few blocks that go beyond UINT16_MAX are kept in an overflow map.
+//Accesses are also aggregated on the fly in a heatmap with a fixed number of bins, so the output
+//does not grow with the size of the file.
+
+//blocks of each page of counters
+#define ACCESS_PAGE_BLOCKS 65536
+//bins of the heatmap (default of the access_bins option)
+#define ACCESS_BINS 1024
+
+//accesses of a block beyond UINT16_MAX
+struct access_overflow{
+	//block + 1, 0 for free entries
+	uint64_t key;
+	uint64_t count;
+};
+
+struct access_counts{
+	//first block and blocks addressed by the process
+	uint64_t first;
+	uint64_t nblocks;
+
+	uint16_t **pages;
+	uint64_t npages;
+
+	//open addressing table with a power of 2 size, doubled when half full
+	struct access_overflow *overflow;
+	uint64_t overflow_size;
+	uint64_t overflow_used;
+
+	//accesses and blocks accessed of each bin of bin_blocks blocks
+	uint64_t bin_blocks;
+	uint64_t nbins;
+	uint64_t *bin_accesses;
+	uint64_t *bin_touched;
+};
+
+//counters of nblocks blocks starting at block first, with a heatmap of at most nbins bins
+//(0 for one bin per block)
+struct access_counts* access_counts_create(uint64_t first, uint64_t nblocks, uint64_t nbins);
+
+//count an access to the n blocks starting at block blk, no-op without counters
+void count_accesses(struct access_counts *ac, uint64_t blk, uint64_t n);
+
+//accesses to block first+i
+uint64_t access_count(struct access_counts *ac, uint64_t i);
+
+void access_counts_destroy(struct access_counts *ac);
+
+#endif
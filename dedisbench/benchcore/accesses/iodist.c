@@ -2,36 +2,164 @@
  * (c) 2010 2010 U. Minho. Written by J. Paulo
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include "iodist.h"
+#include "../regions/regions.h"
 #include "../../utils/random/random.h"
 
 
 uint64_t c_nurand=0;
 uint64_t a_nurand=0;
 
+//zipfian sampler of the process (see get_ioposition_zipf)
+static uint64_t zipf_n=0;
+static double zipf_theta=0;
+static double zipf_hx1=0;
+static double zipf_hn=0;
+static double zipf_s=0;
+//ranks are spread over the file by multiplying them by zipf_mult (coprime with zipf_n)
+static uint64_t zipf_mult=1;
 
-int initialize_nurand(uint64_t totb){
+//operations performed with the hot set pattern, the hot set moves every hot_shift
+static uint64_t hot_ops=0;
+
+//next block of each sequential stream (relative to the start of its region)
+static uint64_t *stream_pos=NULL;
+static uint64_t stream_next=0;
+
+
+int initialize_nurand(struct rng *rng, uint64_t totb){
 
 	//TODO: this should vary accordingly to the range size
 	a_nurand = totb/10;
 
 	//C
-	c_nurand = genrand(a_nurand+1);
+	c_nurand = rng_range(rng, a_nurand+1);
 
     return 0;
 
 }
 
-int init_ioposition(struct user_confs *conf){
+//helpers of the rejection-inversion sampler, log1p(x)/x and (exp(x)-1)/x
+//that remain precise when x is close to 0
+static double zipf_helper1(double x){
+  if(fabs(x)>1e-8){
+    return log1p(x)/x;
+  }
+  return 1.0-x*(0.5-x*(1.0/3.0-x*0.25));
+}
 
-  if (conf->accesstype==TPCC){
-    initialize_nurand(conf->totblocks);
+static double zipf_helper2(double x){
+  if(fabs(x)>1e-8){
+    return expm1(x)/x;
   }
+  return 1.0+x*0.5*(1.0+x*(1.0/3.0)*(1.0+x*0.25));
+}
+
+//h(x)=1/x^theta, its integral H and the inverse of H
+static double zipf_h(double x){
+  return exp(-zipf_theta*log(x));
+}
+
+static double zipf_hintegral(double x){
+  double logx=log(x);
+  return zipf_helper2((1.0-zipf_theta)*logx)*logx;
+}
+
+static double zipf_hintegral_inverse(double x){
+  double t=x*(1.0-zipf_theta);
+  if(t<-1.0){
+    t=-1.0;
+  }
+  return exp(zipf_helper1(t)*x);
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b){
+  while(b>0){
+    uint64_t t=a%b;
+    a=b;
+    b=t;
+  }
+  return a;
+}
+
+static void init_zipf(uint64_t n, double theta){
+
+  zipf_n=n;
+  zipf_theta=theta;
+  zipf_hx1=zipf_hintegral(1.5)-1.0;
+  zipf_hn=zipf_hintegral(n+0.5);
+  zipf_s=2.0-zipf_hintegral_inverse(zipf_hintegral(2.5)-zipf_h(2.0));
+
+  //golden ratio multiplier, so that popular blocks are not all at the beginning of the file
+  zipf_mult=((uint64_t) (n*0.6180339887))|1;
+  while(gcd(zipf_mult, n)!=1){
+    zipf_mult+=2;
+  }
+}
+
+int init_ioposition(struct user_confs *conf, struct rng *rng){
+
+  //phases of the schedule may switch to TPCC
+  if (conf->accesstype==TPCC || conf->nphases>0){
+    initialize_nurand(rng, conf->totblocks);
+  }
+
+  init_zipf(region_blocks(conf), conf->zipf_theta);
+
+  hot_ops=0;
+
+  free(stream_pos);
+  stream_pos=calloc(conf->nstreams, sizeof(uint64_t));
+  stream_next=0;
 
   return 0;
 
 }
 
+int parse_access_type(const char *value){
+
+  // 0 - sequential | 1 - Rand uniform | 2 - NURand | 3 - zipfian | 4 - hot set | 5 - sequential streams
+  switch(atoi(value)){
+    case 0: return SEQUENTIAL;
+    case 1: return UNIFORM;
+    case 2: return TPCC;
+    case 3: return ZIPF;
+    case 4: return HOTSET;
+    case 5: return STREAMS;
+    default:
+      return -1;
+  }
+}
+
+int init_access_patterns(struct user_confs *conf){
+
+  if(conf->zipf_theta<=0){
+    printf("zipf_theta must be higher than 0\n");
+    return -1;
+  }
+
+  if(strlen(conf->hotset)>0){
+    unsigned long long int shift;
+    if(sscanf(conf->hotset, "%d/%d/%llu", &conf->hot_perc, &conf->hot_access, &shift)!=3 ||
+       conf->hot_perc<=0 || conf->hot_perc>=100 || conf->hot_access<0 || conf->hot_access>100){
+      printf("wrong hotset option, the format is <hot blocks %%>/<accesses %%>/<operations between shifts>\n");
+      return -1;
+    }
+    conf->hot_shift=shift;
+  }
+
+  if(conf->nstreams<=0){
+    printf("streams must be higher than 0\n");
+    return -1;
+  }
+
+  return 0;
+}
+
 //The position on the file (block address) to be written is given by TPCC NURrand funcion
 //NURand(A, x, y) = (((random(0, A) | random(x, y)) + C) % (y - x + 1)) + x
 //http://www.tpc.org/tpcc/spec/tpcc_current.pdf
@@ -39,7 +167,7 @@ int init_ioposition(struct user_confs *conf){
 //TODO: these values could be adjusted better for the workload in the future
 // x,y range of positions; A varies accordingly to the range size; C is a random
 //between 0 and A
-uint64_t get_ioposition_tpcc(uint64_t totb, uint64_t block_size){
+uint64_t get_ioposition_tpcc(struct rng *rng, uint64_t totb, uint64_t block_size){
 
   //A=9000
   //x is zero TODO: this could also be a parameter...
@@ -48,7 +176,7 @@ uint64_t get_ioposition_tpcc(uint64_t totb, uint64_t block_size){
   uint64_t y = totb-1;
 
   //Calculate NURand function
-  uint64_t res = ((( genrand(a_nurand) | genrand(y)) + c_nurand) % (y - x + 1)) + x ;
+  uint64_t res = ((( rng_range(rng, a_nurand) | rng_range(rng, y)) + c_nurand) % (y - x + 1)) + x ;
 
   //OUt of range... this should not happen
   if(res>totb-1)
@@ -61,11 +189,11 @@ uint64_t get_ioposition_tpcc(uint64_t totb, uint64_t block_size){
 }
 
 
-uint64_t get_ioposition_uniform(uint64_t totb, uint64_t block_size){
+uint64_t get_ioposition_uniform(struct rng *rng, uint64_t totb, uint64_t block_size){
 
 
   //Uniform distribution
-  uint64_t res = genrand(totb-1);
+  uint64_t res = rng_range(rng, totb);
 
   //OUt of range... this should not happen
   if(res>totb-1)
@@ -77,6 +205,97 @@ uint64_t get_ioposition_uniform(uint64_t totb, uint64_t block_size){
   return resf;
 }
 
+void fill_ioposition_uniform(struct rng *rng, uint64_t totb, uint64_t block_size, uint64_t *out, uint64_t n){
+
+  uint64_t i;
+
+  rng_fill_range(rng, totb, out, n);
+  for(i=0;i<n;i++){
+    out[i]*=block_size;
+  }
+}
+
+//Zipfian popularity of blocks with rejection-inversion sampling (W. Hormann and G. Derflinger,
+//Rejection-inversion to generate variates from monotone discrete distributions), O(1) per
+//sample without tables. Ranks are then spread over the file and wrapped to the totb positions
+uint64_t get_ioposition_zipf(struct rng *rng, uint64_t totb, uint64_t block_size){
+
+  uint64_t k;
+
+  while(1){
+    double u=zipf_hn+rng_double(rng)*(zipf_hx1-zipf_hn);
+    double x=zipf_hintegral_inverse(u);
+    k=(uint64_t) (x+0.5);
+    if(k<1){
+      k=1;
+    }else if(k>zipf_n){
+      k=zipf_n;
+    }
+    if(k-x<=zipf_s || u>=zipf_hintegral(k+0.5)-zipf_h(k)){
+      break;
+    }
+  }
+
+  uint64_t res=(uint64_t) (((unsigned __int128) (k-1)*zipf_mult)%zipf_n);
+  //requests with more than one block cannot start in the last blocks of the file, their ranks
+  //wrap to the first blocks instead of all going to the last start position
+  res=res%totb;
+
+  return res*block_size;
+}
+
+//hot_perc% of the blocks get hot_access% of the accesses, the hot set moves to the
+//following blocks every hot_shift operations (0 keeps it still)
+uint64_t get_ioposition_hotset(struct rng *rng, struct user_confs *conf, uint64_t nblocks, uint64_t totb, uint64_t block_size){
+
+  uint64_t hot_blocks=(nblocks*conf->hot_perc)/100;
+  uint64_t res;
+
+  if(hot_blocks==0){
+    hot_blocks=1;
+  }
+
+  uint64_t shifts = (conf->hot_shift>0) ? hot_ops/conf->hot_shift : 0;
+  uint64_t hot_start=(shifts*hot_blocks)%nblocks;
+  hot_ops++;
+
+  if(rng_range(rng, 100)<conf->hot_access){
+    res=(hot_start+rng_range(rng, hot_blocks))%nblocks;
+  }else{
+    //cold blocks are the ones after the hot set
+    res=(hot_start+hot_blocks+rng_range(rng, nblocks-hot_blocks))%nblocks;
+  }
+
+  //requests with more than one block cannot start in the last blocks of the file
+  res=res%totb;
+
+  return res*block_size;
+}
+
+//nstreams sequential streams, each in its own region of the file, take turns issuing requests
+uint64_t get_ioposition_streams(struct user_confs *conf, uint64_t nblocks, uint64_t reqblocks, uint64_t block_size){
+
+  uint64_t s=stream_next;
+  stream_next=(stream_next+1)%conf->nstreams;
+
+  //streams share the whole file when the regions are too small for the request
+  uint64_t region=nblocks/conf->nstreams;
+  uint64_t base=s*region;
+  if(region<reqblocks){
+    region=nblocks;
+    base=0;
+  }
+
+  //requests wrap around when they do not fit at the end of the region
+  if(stream_pos[s]+reqblocks>region){
+    stream_pos[s]=0;
+  }
+  uint64_t res=base+stream_pos[s];
+  stream_pos[s]+=(conf->stream_stride>0) ? conf->stream_stride : reqblocks;
+
+  return res*block_size;
+}
+
 uint64_t get_ioposition_seq(uint64_t totb,uint64_t cont, uint64_t block_size){
 
   //res gives a block id and we convert to physical address
@@ -85,37 +304,72 @@ uint64_t get_ioposition_seq(uint64_t totb,uint64_t cont, uint64_t block_size){
   return resf;
 }
 
-uint64_t get_ioposition(struct user_confs *conf, struct stats *stat, int idproc){
+//offset of a request with nblocks blocks, the request never goes beyond the end of the file
+uint64_t get_ioposition(struct user_confs *conf, struct stats *stat, int idproc, uint64_t nblocks){
 
   uint64_t iooffset;
-  uint64_t total_blocks=conf->totblocks;
+  uint64_t total_blocks=region_blocks(conf);
 
-  
-  if(conf->rawdevice==1){
-    total_blocks=total_blocks/conf->nprocs;
-  }
+  //number of positions where a request with nblocks can start
+  uint64_t start_blocks=total_blocks-(nblocks-1);
 
     if(conf->accesstype==SEQUENTIAL){
+           //requests with more than one block wrap around when they do not fit at the end of the file
+           if((stat->seq_block%total_blocks)>=start_blocks){
+             stat->seq_block+=total_blocks-(stat->seq_block%total_blocks);
+           }
            //Get the position to perform I/O operation
-           iooffset = get_ioposition_seq(total_blocks, stat->tot_ops, conf->block_size);
+           iooffset = get_ioposition_seq(total_blocks, stat->seq_block, conf->block_size);
+           stat->seq_block+=nblocks;
          }else{
            if(conf->accesstype==UNIFORM){
-             //Get the position to perform I/O operation
-             iooffset = get_ioposition_uniform(total_blocks, conf->block_size);
+             //offsets are drawn in batches for the start positions of the request that finds
+             //the batch empty, requests of other sizes draw theirs one at a time
+             if(stat->offsets_left==0){
+               fill_ioposition_uniform(&stat->rng, start_blocks, conf->block_size, stat->offsets, RNG_BATCH);
+               stat->offsets_left=RNG_BATCH;
+               stat->offsets_range=start_blocks;
+             }
+             if(stat->offsets_range==start_blocks){
+               iooffset = stat->offsets[RNG_BATCH-stat->offsets_left--];
+             }else{
+               iooffset = get_ioposition_uniform(&stat->rng, start_blocks, conf->block_size);
+             }
+           }
+           else if(conf->accesstype==ZIPF){
+             iooffset = get_ioposition_zipf(&stat->rng, start_blocks, conf->block_size);
+           }
+           else if(conf->accesstype==HOTSET){
+             iooffset = get_ioposition_hotset(&stat->rng, conf, total_blocks, start_blocks, conf->block_size);
+           }
+           else if(conf->accesstype==STREAMS){
+             iooffset = get_ioposition_streams(conf, total_blocks, nblocks, conf->block_size);
            }
            else{
              //Get the position to perform I/O operation
-            iooffset = get_ioposition_tpcc(total_blocks, conf->block_size);
+            iooffset = get_ioposition_tpcc(&stat->rng, start_blocks, conf->block_size);
 
            }
          }
 
-    if(conf->rawdevice==1){
-      iooffset = ((total_blocks*conf->block_size)*idproc)+iooffset;
-    }
+    //move to the region of the process in the raw device (0 for files)
+    iooffset = region_first(conf, idproc)*conf->block_size+iooffset;
 
     return iooffset;
 
 }
 
+//offset of a request with nblocks blocks that starts at offset next (used for runs of
+//duplicated blocks), wraps to the beginning of the file or of the process region of the raw device
+uint64_t get_ioposition_next(struct user_confs *conf, int idproc, uint64_t next, uint64_t nblocks){
+
+  uint64_t total_blocks=region_blocks(conf);
+  uint64_t base=region_first(conf, idproc)*conf->block_size;
 
+  uint64_t block=(next-base)/conf->block_size;
+  if(block+nblocks>total_blocks){
+    block=0;
+  }
+
+  return base+block*conf->block_size;
+}
@@ -8,14 +8,25 @@
 
 #include <stdint.h>
 #include "../../structs/defines.h"
+#include "../../utils/random/random.h"
 
 
 
 //TODO: should this first call be public?
-int init_ioposition(struct user_confs *conf);
-uint64_t get_ioposition(struct user_confs *conf, struct stats *stat, int idproc);
-uint64_t get_ioposition_tpcc(uint64_t totb, uint64_t block_size);
-uint64_t get_ioposition_uniform(uint64_t totb, uint64_t block_size);
+int init_ioposition(struct user_confs *conf, struct rng *rng);
+//access_type option value to SEQUENTIAL, UNIFORM, TPCC, ZIPF, HOTSET or STREAMS (-1 if unknown)
+int parse_access_type(const char *value);
+//check the options of the access patterns, must be called before forking the benchmark processes
+int init_access_patterns(struct user_confs *conf);
+uint64_t get_ioposition(struct user_confs *conf, struct stats *stat, int idproc, uint64_t nblocks);
+uint64_t get_ioposition_next(struct user_confs *conf, int idproc, uint64_t next, uint64_t nblocks);
+uint64_t get_ioposition_tpcc(struct rng *rng, uint64_t totb, uint64_t block_size);
+uint64_t get_ioposition_uniform(struct rng *rng, uint64_t totb, uint64_t block_size);
+//n uniform offsets drawn ahead of time
+void fill_ioposition_uniform(struct rng *rng, uint64_t totb, uint64_t block_size, uint64_t *out, uint64_t n);
+uint64_t get_ioposition_zipf(struct rng *rng, uint64_t totb, uint64_t block_size);
+uint64_t get_ioposition_hotset(struct rng *rng, struct user_confs *conf, uint64_t nblocks, uint64_t totb, uint64_t block_size);
+uint64_t get_ioposition_streams(struct user_confs *conf, uint64_t nblocks, uint64_t reqblocks, uint64_t block_size);
 uint64_t get_ioposition_seq(uint64_t totb,uint64_t cont, uint64_t block_size);
 
 #endif
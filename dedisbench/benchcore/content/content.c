@@ -0,0 +1,239 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "content.h"
+
+//4 xorshift128+ generators run side by side, gcc turns the vector
+//operations into SSE2/AVX2 instructions
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+
+#define VSIZE sizeof(v4u64)
+
+static int content_compressibility=CONTENT_LEGACY;
+//mask applied to each random byte to limit its entropy
+static uint64_t content_mask=UINT64_MAX;
+
+//cache of rendered blocks (one per process, it is created after forking)
+struct content_cache{
+	uint64_t nslots;
+	uint64_t block_size;
+	//content id stored at each slot plus one (0 is an empty slot)
+	uint64_t *tags;
+	char *blocks;
+	uint64_t hits;
+	uint64_t misses;
+};
+
+static struct content_cache cache = {.nslots=0};
+
+
+void init_content(int compressibility, int entropy){
+
+  content_compressibility=compressibility;
+
+  if(entropy<1 || entropy>8){
+    entropy=8;
+  }
+  //only the entropy lower bits of each byte are random
+  content_mask=((1ULL<<entropy)-1)*0x0101010101010101ULL;
+}
+
+//splitmix64, used to seed the generators from the key
+static inline uint64_t mix64(uint64_t x){
+  x+=0x9e3779b97f4a7c15ULL;
+  x=(x^(x>>30))*0xbf58476d1ce4e5b9ULL;
+  x=(x^(x>>27))*0x94d049bb133111ebULL;
+  return x^(x>>31);
+}
+
+uint64_t content_key(uint64_t cont_id, int procid, uint64_t ts){
+  return mix64(cont_id ^ mix64(((uint64_t)(uint32_t)procid<<32) ^ mix64(ts)));
+}
+
+//vectors are only passed by pointer, so the ABI does not depend on AVX being enabled
+static inline void xorshift128p(v4u64 *s0, v4u64 *s1, v4u64 *r){
+  v4u64 x=*s0;
+  v4u64 y=*s1;
+  *s0=y;
+  x^=x<<23;
+  *s1=x^y^(x>>17)^(y>>26);
+  *r=*s1+y;
+}
+
+static inline void seed_stream(uint64_t key, v4u64 *s0, v4u64 *s1){
+  v4u64 a = {mix64(key), mix64(key+1), mix64(key+2), mix64(key+3)};
+  v4u64 b = {mix64(key+4), mix64(key+5), mix64(key+6), mix64(key+7)};
+  *s0=a;
+  *s1=b;
+}
+
+//bytes of a body of size bytes that come from the random stream
+static inline uint64_t random_bytes(uint64_t size){
+  if(content_compressibility==CONTENT_LEGACY){
+    return 0;
+  }
+  return size-(size*content_compressibility)/100;
+}
+
+void fill_block_body(char *buf, uint64_t size, uint64_t key){
+
+  //the random part comes first and the compressible part fills the rest of the body
+  uint64_t nrandom=random_bytes(size);
+  memset(buf+nrandom, CONTENT_FILL, size-nrandom);
+
+  if(nrandom==0){
+    return;
+  }
+
+  v4u64 s0, s1, r;
+  v4u64 mask = {content_mask, content_mask, content_mask, content_mask};
+  seed_stream(key, &s0, &s1);
+
+  uint64_t i;
+  for(i=0;i+VSIZE<=nrandom;i+=VSIZE){
+    xorshift128p(&s0, &s1, &r);
+    r&=mask;
+    memcpy(buf+i, &r, VSIZE);
+  }
+  if(i<nrandom){
+    xorshift128p(&s0, &s1, &r);
+    r&=mask;
+    memcpy(buf+i, &r, nrandom-i);
+  }
+}
+
+int verify_block_body(const char *buf, uint64_t size, uint64_t key){
+
+  uint64_t nrandom=random_bytes(size);
+  uint64_t i;
+  v4u64 s0, s1, r, b;
+  //differences are accumulated and only checked once for each 256 bytes
+  v4u64 diff = {0, 0, 0, 0};
+  v4u64 mask = {content_mask, content_mask, content_mask, content_mask};
+  v4u64 fill;
+  memset(&fill, CONTENT_FILL, VSIZE);
+
+  if(nrandom>0){
+    seed_stream(key, &s0, &s1);
+
+    for(i=0;i+VSIZE<=nrandom;i+=VSIZE){
+      xorshift128p(&s0, &s1, &r);
+      memcpy(&b, buf+i, VSIZE);
+      diff|=b^(r&mask);
+      if((i & 255)==224 && (diff[0]|diff[1]|diff[2]|diff[3])){
+        return 1;
+      }
+    }
+    if(i<nrandom){
+      xorshift128p(&s0, &s1, &r);
+      r&=mask;
+      if(memcmp(buf+i, &r, nrandom-i)!=0){
+        return 1;
+      }
+    }
+  }
+
+  //compressible part
+  for(i=nrandom;i+VSIZE<=size;i+=VSIZE){
+    memcpy(&b, buf+i, VSIZE);
+    diff|=b^fill;
+  }
+  for(;i<size;i++){
+    if(buf[i]!=CONTENT_FILL){
+      return 1;
+    }
+  }
+
+  return (diff[0]|diff[1]|diff[2]|diff[3])!=0;
+}
+
+
+void init_content_cache(uint64_t size, uint64_t block_size){
+
+  cache.nslots=size/block_size;
+  cache.block_size=block_size;
+  cache.hits=0;
+  cache.misses=0;
+
+  if(cache.nslots==0){
+    return;
+  }
+
+  cache.tags=calloc(cache.nslots, sizeof(uint64_t));
+  if(posix_memalign((void **) &cache.blocks, 4096, cache.nslots*block_size)!=0 || !cache.tags){
+    perror("Error allocating the content cache");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void free_content_cache(uint64_t *hits, uint64_t *misses){
+
+  *hits=cache.hits;
+  *misses=cache.misses;
+
+  if(cache.nslots>0){
+    free(cache.tags);
+    free(cache.blocks);
+    cache.nslots=0;
+  }
+}
+
+//rendered image of a block with duplicated content, NULL if it is not cached
+static inline char* cache_lookup(uint64_t block_size, uint64_t cont_id, int procid){
+
+  //unique blocks are never written twice, they are not cached
+  if(cache.nslots==0 || procid!=-1 || block_size!=cache.block_size){
+    return NULL;
+  }
+
+  uint64_t slot=mix64(cont_id)%cache.nslots;
+  char *img=cache.blocks+slot*cache.block_size;
+
+  if(cache.tags[slot]==cont_id+1){
+    cache.hits++;
+    return img;
+  }
+
+  //replace the block at the slot
+  cache.misses++;
+  struct block_header hdr = {.magic=CONTENT_MAGIC, .procid=procid, .cont_id=cont_id, .ts=UINT64_MAX};
+  memcpy(img, &hdr, sizeof(struct block_header));
+  fill_block_body(img+sizeof(struct block_header), block_size-sizeof(struct block_header), content_key(cont_id, procid, UINT64_MAX));
+  cache.tags[slot]=cont_id+1;
+
+  return img;
+}
+
+void fill_block(char *buf, uint64_t block_size, uint64_t cont_id, int procid, uint64_t ts){
+
+  char *img=cache_lookup(block_size, cont_id, procid);
+  if(img){
+    memcpy(buf, img, block_size);
+    return;
+  }
+
+  struct block_header hdr = {.magic=CONTENT_MAGIC, .procid=procid, .cont_id=cont_id, .ts=ts};
+
+  memcpy(buf, &hdr, sizeof(struct block_header));
+  fill_block_body(buf+sizeof(struct block_header), block_size-sizeof(struct block_header), content_key(cont_id, procid, ts));
+}
+
+int verify_block(const char *buf, uint64_t block_size, uint64_t cont_id, int procid, uint64_t ts){
+
+  char *img=cache_lookup(block_size, cont_id, procid);
+  if(img){
+    return memcmp(buf, img, block_size)!=0;
+  }
+
+  struct block_header hdr = {.magic=CONTENT_MAGIC, .procid=procid, .cont_id=cont_id, .ts=ts};
+
+  if(memcmp(buf, &hdr, sizeof(struct block_header))!=0){
+    return 1;
+  }
+  return verify_block_body(buf+sizeof(struct block_header), block_size-sizeof(struct block_header), content_key(cont_id, procid, ts));
+}
@@ -0,0 +1,57 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef CONTENT_H
+#define CONTENT_H
+
+#include <stdint.h>
+
+//body of the blocks is filled with 'a' (original DEDISbench content)
+#define CONTENT_LEGACY -1
+
+//byte used for the compressible part of the body
+#define CONTENT_FILL 'a'
+
+//first bytes of every block written by DEDISbench ("DEDI")
+#define CONTENT_MAGIC 0x49444544
+
+//fixed-width header at the beginning of each block, the body follows it
+struct block_header{
+	uint32_t magic;
+	//process that wrote an unique block, -1 for duplicated content
+	int32_t procid;
+	uint64_t cont_id;
+	//time when an unique block was generated, -1 for duplicated content
+	uint64_t ts;
+};
+
+//set how the body of the blocks is generated, must be called before forking the benchmark processes
+//compressibility: percentage of the body filled with CONTENT_FILL or CONTENT_LEGACY
+//entropy: bits of entropy of each byte in the rest of the body (1 to 8, 8 is incompressible)
+void init_content(int compressibility, int entropy);
+
+//key of the pseudo-random stream of a block, identical blocks have the same key
+uint64_t content_key(uint64_t cont_id, int procid, uint64_t ts);
+
+//fill size bytes of buf with the body of the block with the given key
+void fill_block_body(char *buf, uint64_t size, uint64_t key);
+
+//0 if the size bytes of buf are the body of the block with the given key,
+//the expected body is generated and compared on the fly (it is never materialized)
+int verify_block_body(const char *buf, uint64_t size, uint64_t key);
+
+//direct-mapped cache of rendered blocks with duplicated content, private to each
+//benchmark process, hot duplicated content ids are written with a single memcpy
+//size is given in bytes, 0 disables the cache
+void init_content_cache(uint64_t size, uint64_t block_size);
+void free_content_cache(uint64_t *hits, uint64_t *misses);
+
+//write a whole block: header followed by the body
+void fill_block(char *buf, uint64_t block_size, uint64_t cont_id, int procid, uint64_t ts);
+
+//0 if buf holds the block described by cont_id, procid and ts
+int verify_block(const char *buf, uint64_t block_size, uint64_t cont_id, int procid, uint64_t ts);
+
+#endif
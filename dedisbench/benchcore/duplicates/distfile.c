@@ -0,0 +1,234 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "distfile.h"
+
+
+//add nb blocks with dn occurrences each to the table
+static int add_entry(struct dist_table *t, uint64_t *cap, uint64_t dn, uint64_t nb){
+
+	if(nb==0){
+		return 0;
+	}
+
+	if(dn==1){
+		t->zero_copy_blocks+=nb;
+	}else{
+		if(t->nentries==*cap){
+			*cap = (*cap==0) ? 256 : *cap*2;
+			struct dist_entry *e = realloc(t->entries, sizeof(struct dist_entry)*(*cap));
+			if(!e){
+				perror("Error allocating distribution");
+				return -1;
+			}
+			t->entries=e;
+		}
+		t->entries[t->nentries].dups=dn;
+		t->entries[t->nentries].nblocks=nb;
+		t->nentries++;
+		t->duplicated_blocks+=nb;
+	}
+	t->total_blocks+=nb*dn;
+
+	return 0;
+}
+
+//read an unsigned number at *p (without going past end), returns -1 if there is none
+static int parse_number(const char **p, const char *end, uint64_t *v){
+
+	const char *s=*p;
+	uint64_t n=0;
+
+	if(s==end || *s<'0' || *s>'9'){
+		return -1;
+	}
+	while(s<end && *s>='0' && *s<='9'){
+		uint64_t d=*s-'0';
+		if(n>(UINT64_MAX-d)/10){
+			return -1;
+		}
+		n=n*10+d;
+		s++;
+	}
+
+	*p=s;
+	*v=n;
+	return 0;
+}
+
+static int parse_text(const char *fname, const char *p, const char *end, struct dist_table *t){
+
+	uint64_t cap=0;
+	uint64_t line=1;
+
+	while(p<end){
+		uint64_t dup, nb;
+
+		//blank lines are ignored
+		if(*p=='\n' || *p=='\r'){
+			if(*p=='\n'){
+				line++;
+			}
+			p++;
+			continue;
+		}
+
+		if(parse_number(&p, end, &dup)<0 || p==end || (*p!=' ' && *p!='\t')){
+			printf("%s:%llu: expected <number_duplicates> <number_blocks>\n", fname, (unsigned long long int) line);
+			return -1;
+		}
+		while(p<end && (*p==' ' || *p=='\t')){
+			p++;
+		}
+		if(parse_number(&p, end, &nb)<0){
+			printf("%s:%llu: expected <number_duplicates> <number_blocks>\n", fname, (unsigned long long int) line);
+			return -1;
+		}
+		while(p<end && (*p==' ' || *p=='\t' || *p=='\r')){
+			p++;
+		}
+		if(p<end && *p!='\n'){
+			printf("%s:%llu: unexpected characters after <number_blocks>\n", fname, (unsigned long long int) line);
+			return -1;
+		}
+
+		//the file has the number of duplicates and the table the occurrences
+		if(add_entry(t, &cap, dup+1, nb)<0){
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int parse_binary(const char *fname, const char *p, uint64_t size, struct dist_table *t){
+
+	struct dist_header hdr;
+	uint64_t i;
+	memcpy(&hdr, p, sizeof(struct dist_header));
+
+	//nentries is checked against the file size before it is multiplied, so it cannot overflow
+	if(hdr.version!=DIST_VERSION || hdr.entry_size!=sizeof(struct dist_entry) ||
+		hdr.nentries!=(size-sizeof(struct dist_header))/sizeof(struct dist_entry) ||
+		size!=sizeof(struct dist_header)+hdr.nentries*sizeof(struct dist_entry)){
+		printf("%s was written by an incompatible version or is truncated\n", fname);
+		return -1;
+	}
+
+	t->entries=malloc(sizeof(struct dist_entry)*(hdr.nentries+1));
+	if(!t->entries){
+		perror("Error allocating distribution");
+		return -1;
+	}
+	memcpy(t->entries, p+sizeof(struct dist_header), sizeof(struct dist_entry)*hdr.nentries);
+	t->nentries=hdr.nentries;
+
+	//the totals of the header are recomputed from the entries, as parse_text does
+	t->zero_copy_blocks=hdr.zero_copy_blocks;
+	t->total_blocks=hdr.zero_copy_blocks;
+	for(i=0;i<t->nentries;i++){
+		struct dist_entry *e = &t->entries[i];
+		if(e->dups<2 || e->nblocks==0 || e->nblocks>(UINT64_MAX-t->total_blocks)/e->dups){
+			printf("%s has an invalid entry %llu\n", fname, (unsigned long long int) i);
+			return -1;
+		}
+		t->duplicated_blocks+=e->nblocks;
+		t->total_blocks+=e->nblocks*e->dups;
+	}
+
+	if(t->duplicated_blocks!=hdr.duplicated_blocks || t->total_blocks!=hdr.total_blocks){
+		printf("%s is corrupted, its totals do not match its entries\n", fname);
+		return -1;
+	}
+
+	return 0;
+}
+
+int read_distribution(const char *fname, struct dist_table *t){
+
+	memset(t, 0, sizeof(struct dist_table));
+
+	int fd = open(fname, O_RDONLY);
+	if(fd==-1){
+		printf("could not open distribution file %s\n", fname);
+		return -1;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st)!=0 || st.st_size==0){
+		printf("distribution file %s is empty\n", fname);
+		close(fd);
+		return -1;
+	}
+
+	char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map==MAP_FAILED){
+		perror("Error mmapping distribution file");
+		return -1;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	int ret;
+	if(st.st_size>=sizeof(struct dist_header) && memcmp(map, DIST_MAGIC, 8)==0){
+		ret = parse_binary(fname, map, st.st_size, t);
+	}else{
+		ret = parse_text(fname, map, map+st.st_size, t);
+	}
+
+	munmap(map, st.st_size);
+
+	if(ret==0 && t->total_blocks==0){
+		printf("distribution file %s has no blocks\n", fname);
+		ret=-1;
+	}
+	if(ret<0){
+		free_distribution(t);
+	}
+
+	return ret;
+}
+
+int write_distribution(const char *fname, struct dist_table *t){
+
+	struct dist_header hdr;
+	memset(&hdr, 0, sizeof(struct dist_header));
+	memcpy(hdr.magic, DIST_MAGIC, 8);
+	hdr.version=DIST_VERSION;
+	hdr.entry_size=sizeof(struct dist_entry);
+	hdr.nentries=t->nentries;
+	hdr.zero_copy_blocks=t->zero_copy_blocks;
+	hdr.duplicated_blocks=t->duplicated_blocks;
+	hdr.total_blocks=t->total_blocks;
+
+	FILE *fp = fopen(fname, "w");
+	if(!fp){
+		perror("Error creating precompiled distribution file");
+		return -1;
+	}
+	if(fwrite(&hdr, sizeof(struct dist_header), 1, fp)!=1 ||
+		fwrite(t->entries, sizeof(struct dist_entry), t->nentries, fp)!=t->nentries){
+		perror("Error writing precompiled distribution file");
+		fclose(fp);
+		return -1;
+	}
+
+	return fclose(fp);
+}
+
+void free_distribution(struct dist_table *t){
+	free(t->entries);
+	t->entries=NULL;
+	t->nentries=0;
+}
@@ -0,0 +1,56 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef DISTFILE_H
+#define DISTFILE_H
+
+#include <stdint.h>
+
+//precompiled distribution files start with this magic (see DEDISgen -c)
+#define DIST_MAGIC "DEDISDST"
+#define DIST_VERSION 1
+
+//a line of the distribution file: nblocks distinct blocks with dups occurrences each
+struct dist_entry{
+	uint64_t dups;
+	uint64_t nblocks;
+};
+
+//first bytes of a precompiled distribution file, the entries follow it
+struct dist_header{
+	char magic[8];
+	uint32_t version;
+	//size of each dist_entry, for readers to check compatibility
+	uint32_t entry_size;
+	uint64_t nentries;
+	uint64_t zero_copy_blocks;
+	uint64_t duplicated_blocks;
+	uint64_t total_blocks;
+};
+
+//distribution parsed from a text or precompiled file
+struct dist_table{
+	//classes of blocks with duplicates (dups>1), blocks without duplicates are only counted
+	struct dist_entry *entries;
+	uint64_t nentries;
+	//blocks without duplicates
+	uint64_t zero_copy_blocks;
+	//distinct blocks with duplicates
+	uint64_t duplicated_blocks;
+	//blocks of the dataset, counting every copy
+	uint64_t total_blocks;
+};
+
+//parse a distribution file in a single pass over its mmapped content, either the
+//text format (<number_duplicates> <number_blocks> per line) or a precompiled one
+//returns 0 or -1 (with the error printed) if the file cannot be read or is malformed
+int read_distribution(const char *fname, struct dist_table *t);
+
+//write t as a precompiled distribution file, returns 0 or -1
+int write_distribution(const char *fname, struct dist_table *t);
+
+void free_distribution(struct dist_table *t);
+
+#endif
@@ -11,387 +11,276 @@
 #include <time.h>
 
 #include "duplicatedist.h"
+#include "distfile.h"
+#include "../content/content.h"
 #include "../../utils/random/random.h"
+#include "../../utils/utils.h"
 
 
 
 
-void get_distribution_stats(struct duplicates_info *info, char* fname){
+//load the distribution file, it is kept as classes (one for each line of the file) and not
+//expanded to one entry per block, the last class is the blocks without duplicates
+void load_distribution(struct duplicates_info *info, char* fname){
 
-	//open file with distribution
-	//number_of_duplicates number_blocks_with_those_duplicates
-	FILE *fp = fopen(fname,"r");
-	//if the file did not opened try in alternative directory
-	//TODO THis is a temporary FIX
-	if(!fp){
-		printf("could not open distribution file %s\n",fname);
-		exit(0);
-	}
-
-
-	//TODO: find reasonable size
-	char line[50];
-	bzero(line,sizeof(line));
-
-	if(fp){
-	  //read lines from line until end of document
-	  while(fgets(line, sizeof(line), fp)) {
-
-	  	  //TODO: find reasonable size
-	      char dup[20];
-	      int i =0;
-
-	      //read number of duplicates
-	      while(line[i]!=' '){
-	          dup[i]=line[i];
-	          i++;
-	      }
-	      dup[i]='\0';
-	      i++;
-
-	      //TODO: find reasonable size
-	      char nblocks[20];
-	      int j =0;
-
-
-	      //read number of blocks with that number of duplicates
-	      while(line[i]!='\n'){
-	          nblocks[j]=line[i];
-	          i++;
-              j++;
-	      }
-          nblocks[j]='\0';
+  struct dist_table t;
+  uint64_t c;
+  //content ids of each class follow the ones of the previous class
+  uint64_t first_id=0;
 
-          uint64_t dn; //number of duplicated blocks
-          uint64_t nb; //number of blocks
-
-          //convert to uint64_t
-          dn = atoll(dup) + 1 ; // add more 1 because the array stores the occurrences and not the number of duplicates
-          nb = atoll(nblocks); //number of blocks with N ocurrences where N is dn
-
-          if(dn==1){
-        	  info->zero_copy_blocks=nb;
-          }else{
-        	  //total of blocks with duplicates (only 1 of the blocks is considered)
-        	  //in other words, number of blocks with different content that are dup
-        	  info->duplicated_blocks=info->duplicated_blocks + nb;
-
-          }
-          info->total_blocks = info->total_blocks + (nb*dn);
-
-	      //zero the structs
-	      bzero(nblocks,sizeof(nblocks));
-	      bzero(dup,sizeof(dup));
+  if(read_distribution(fname, &t)<0){
+    exit(0);
+  }
 
-	     }
+  info->classes=malloc(sizeof(struct dup_class)*(t.nentries+1));
+  if(!info->classes){
+    perror("Error allocating duplicate classes");
+    exit(EXIT_FAILURE);
+  }
 
+  // example if 5 different blocks have 7 duplicates then the class is {8, 5, first_id}
+  // and its blocks have content ids first_id to first_id+4
+  for(c=0;c<t.nentries;c++){
+    info->classes[c].dups=t.entries[c].dups;
+    info->classes[c].nblocks=t.entries[c].nblocks;
+    info->classes[c].first_id=first_id;
+    first_id+=t.entries[c].nblocks;
+  }
+  info->nclasses=t.nentries;
 
-	  fclose(fp);
-	  }
-	  else{
+  //blocks without duplicates get a new unique id when written
+  info->classes[info->nclasses].dups=1;
+  info->classes[info->nclasses].nblocks=t.zero_copy_blocks;
+  info->classes[info->nclasses].first_id=first_id;
 
-		  perror("failed to load the duplicate distribution file");
-		  exit(0);
+  info->zero_copy_blocks=t.zero_copy_blocks;
+  info->duplicated_blocks=t.duplicated_blocks;
+  info->total_blocks=t.total_blocks;
 
-	  }
+  free_distribution(&t);
 
-    //unique counter for each process
-    //starts with value==max index at array sum
-    //since duplicated content is identified by number correspondent to the indexes at sum
-    //none will have a identifier bigger than this
-    info->u_count = info->duplicated_blocks+1;
+  //unique counter for each process
+  //starts with value==max index at array sum
+  //since duplicated content is identified by number correspondent to the indexes at sum
+  //none will have a identifier bigger than this
+  info->u_count = info->duplicated_blocks+1;
 
+  printf("loaded duplicate distribution with the following statistics:\nTotal Blocks: %llu\nBlocks Without Duplicates %llu\nDistinct Blocks with Duplicates %llu\nDuplicated Blocks %llu\n\n\n",(unsigned long long int) info->total_blocks,(unsigned long long int) info->zero_copy_blocks,(unsigned long long int) info->duplicated_blocks, (unsigned long long int) info->total_blocks-info->zero_copy_blocks-info->duplicated_blocks);
 }
 
+//builds the alias table used to pick a class with probability proportional to
+//the number of blocks of the dataset that belong to it (nblocks*dups)
+void load_alias_table(struct duplicates_info *info){
 
-//fname = block4
-//Load duplicate distribution
-void load_duplicates(struct duplicates_info *info, char* fname){
+  uint64_t c;
 
+  info->alias=malloc(sizeof(struct alias_entry)*(info->nclasses+1));
+  if(!info->alias){
+    perror("Error allocating the alias table");
+    exit(EXIT_FAILURE);
+  }
 
-	//info->stats=malloc(sizeof(uint64_t)*info->duplicated_blocks);
-    int statscont =0;
-
-    //open file with distribution
-    //number_of_duplicates number_blocks_with_those_duplicates
-    FILE *fp = fopen(fname,"r");
-    //if the file did not opened try in alternative directory
-    //THis is a temporary FIX
-    if(!fp){
-    	printf("could not open distribution file %s\n",fname);
-      exit(0);
+  //Vose's method: entries are split in the ones below and above the average weight,
+  //each small entry is filled up to the average with the weight of a large one
+  uint64_t n = info->nclasses+1;
+  double *w = malloc(sizeof(double)*n);
+  uint64_t *small = malloc(sizeof(uint64_t)*n);
+  uint64_t *large = malloc(sizeof(uint64_t)*n);
+  uint64_t ns=0, nl=0;
+
+  for(c=0;c<n;c++){
+    w[c]=((double)info->classes[c].nblocks*info->classes[c].dups*n)/info->total_blocks;
+    if(w[c]<1.0){
+      small[ns++]=c;
+    }else{
+      large[nl++]=c;
     }
+  }
 
-    //TODO: find reasonable size
-    char line[50];
-    bzero(line,sizeof(line));
+  while(ns>0 && nl>0){
+    uint64_t s=small[--ns];
+    uint64_t l=large[nl-1];
 
-    if(fp){
-    //read lines from line until end of document
-    while(fgets(line, sizeof(line), fp)) {
+    info->alias[s].prob=w[s]*ALIAS_SCALE;
+    info->alias[s].alias=l;
 
-    	  //TODO: find reasonable size
-          char dup[20];
-          int i =0;
+    w[l]=(w[l]+w[s])-1.0;
+    if(w[l]<1.0){
+      nl--;
+      small[ns++]=l;
+    }
+  }
+  //remaining entries have weight 1 (up to rounding errors)
+  while(nl>0){
+    c=large[--nl];
+    info->alias[c].prob=ALIAS_SCALE;
+    info->alias[c].alias=c;
+  }
+  while(ns>0){
+    c=small[--ns];
+    info->alias[c].prob=ALIAS_SCALE;
+    info->alias[c].alias=c;
+  }
 
-          //read number of duplicates
-          while(line[i]!=' '){
-            dup[i]=line[i];
-            i++;
-          }
-          dup[i]='\0';
-          i++;
+  free(w);
+  free(small);
+  free(large);
+}
 
-          //TODO: find reasonable size
-          char nblocks[20];
-          int j =0;
 
+//pick a class with the alias table, two random numbers and at most two entries read
+static uint64_t get_class(struct duplicates_info *info, struct rng *rng){
 
-          //read number of blocks with that number of duplicates
-          while(line[i]!='\n'){
-            nblocks[j]=line[i];
-            i++;
-            j++;
-          }
-          nblocks[j]='\0';
+  uint64_t c = rng_range(rng, info->nclasses+1);
+  if(rng_range(rng, ALIAS_SCALE)>=info->alias[c].prob){
+    c = info->alias[c].alias;
+  }
+  return c;
+}
 
-          uint64_t dn; //number of duplicated blocks
-          uint64_t nb; //number of blocks
+//content id of a block of class c
+static uint64_t get_class_contentid(struct duplicates_info *info, struct rng *rng, uint64_t c){
 
-          //convert to uint64_t
-          dn = atoll(dup) + 1 ; // add more 1 because the array stores the occurrences and not the number of duplicates
-          nb = atoll(nblocks); //number of blocks with N ocurrences where N is dn
+  //an unique block withouth duplicates is written
+  if (c==info->nclasses) {
+      //r is equal to the unique counter for generating
+      // a block with unique content from the others generated previously
+      uint64_t r = info->u_count;
+      //increment the counter...
+      info->u_count = info->u_count+1;
+      return r;
+  }
 
-          //populate N entries in the array (1 for each block) with the number of duplicates as value
-          // example if 5 different blocks have 7 duplicates then [...,7,7,7,7,7,...]
-          //exclude the cblocks withouth duplicates(1 occurence)
-          if(dn>1){
-        	while(nb>0){
-              info->stats[statscont] = dn;
+  //the block to be generated has duplicated content, all the blocks of a class
+  //have the same probability
+  return info->classes[c].first_id + rng_range(rng, info->classes[c].nblocks);
+}
 
-              statscont++;
-              nb--;
-            }
-          }
+uint64_t get_contentid(struct duplicates_info *info, struct rng *rng){
+  return get_class_contentid(info, rng, get_class(info, rng));
+}
 
+void get_contentids(struct duplicates_info *info, struct rng *rng, uint64_t *ids, uint64_t n){
 
-          //zero the structs
-          bzero(nblocks,sizeof(nblocks));
-          bzero(dup,sizeof(dup));
+  uint64_t i;
+  //the columns and coins of the alias table are drawn in bulk, ids keeps the columns
+  uint64_t *coins = malloc(sizeof(uint64_t)*n);
 
+  rng_fill_range(rng, info->nclasses+1, ids, n);
+  rng_fill_range(rng, ALIAS_SCALE, coins, n);
 
-     }
+  for(i=0;i<n;i++){
+    uint64_t c = ids[i];
+    if(coins[i]>=info->alias[c].prob){
+      c = info->alias[c].alias;
+    }
+    ids[i] = get_class_contentid(info, rng, c);
+  }
 
-  fclose(fp);
+  free(coins);
+}
 
+//parse the dup_runlength option (<run length>/<percentage> pairs), must be called
+//before forking the benchmark processes
+int init_runlengths(struct user_confs *conf){
 
-  printf("loaded duplicate distribution with the following statistics:\nTotal Blocks: %llu\nBlocks Without Duplicates %llu\nDistinct Blocks with Duplicates %llu\nDuplicated Blocks %llu\n\n\n",(unsigned long long int) info->total_blocks,(unsigned long long int) info->zero_copy_blocks,(unsigned long long int) info->duplicated_blocks, (unsigned long long int) info->total_blocks-info->zero_copy_blocks-info->duplicated_blocks);
+  int i;
+  conf->nrunlength=0;
 
+  if(strlen(conf->runlength)==0){
+    return 0;
   }
-  else{
-
-	  perror("failed to load the duplicate distribution file");
-	  exit(0);
 
+  int n = parse_split(conf->runlength, conf->runlength_len, conf->runlength_perc, BSSPLIT_MAX);
+  if(n<0){
+    printf("wrong dup_runlength option\n");
+    return -1;
   }
-
-}
-
-//function to load the cumulative array for simulating the duplicate distribution
-void load_cumulativedist(struct duplicates_info *info, int distout){
-
-  int i;
-  //size is equal to the number of duplicated blocks (1 for each unique content)
-  //info->sum=malloc(sizeof(uint64_t)*info->duplicated_blocks);
-  //info->statistics=malloc(sizeof(uint64_t)*info->duplicated_blocks);
-
-  info->sum[0]=info->stats[0];
-
-  //cumulative sum of stats array
-  //this way if we generat ea number from 0 to sum[max] for each entry at the
-  // sum array we now that the number will belong to that entry with percentage
-  //equal to the value of that index.
-  //eg: stats -> [5,5,10,10,10] - 2 blocks have 5 dups and 3 have 10 (each block has uniqeu content)
-  // sum -> [5,10,20,30,40] -> now r is random from 0 to 40
-  // if r=(0,5) will belong to sum[0] if r=(20-30) belong to sum[3]
-  //this way we folow the distribution by finding where the value belongs and
-  //generating an unique block for each value at sum
-  for(i=1;i<info->duplicated_blocks;i++){
-    info->sum[i]=info->sum[i-1]+info->stats[i];
-    if(distout==1){
-    	info->statistics[i]=0;
+  for(i=0;i<n;i++){
+    if(conf->runlength_len[i]==0){
+      printf("dup_runlength lengths must be higher than 0\n");
+      return -1;
     }
   }
+  conf->nrunlength=n;
 
-
+  return 0;
 }
 
+//locality model: a duplicated block starts a run of blocks with consecutive content ids
+//of its class (eg: a copied file or VM image), that are written at consecutive offsets
+//(see write_request). The length of each run follows the dup_runlength distribution
+uint64_t get_contentid_run(struct duplicates_info *info, struct user_confs *conf, struct stats *stat){
+
+  //continue the current run
+  if(stat->run_left>0){
+    struct dup_class *cl = &info->classes[stat->run_class];
+    uint64_t id = stat->run_next_id;
+    stat->run_next_id = (id+1<cl->first_id+cl->nblocks) ? id+1 : cl->first_id;
+    stat->run_left--;
+    return id;
+  }
 
-//binary search done to find the block content that we want to generate
-//or the number more close to this value
-uint64_t search(struct duplicates_info *info, uint64_t value,int low, int high, uint64_t *res){
-
-   //when hign is lower that low then the value was not foundat the index and
-   //is between *res and *res-1
-   if (high < low)
-	   return *res;
-
-   //go to the mid value
-   //if low !=0 then is low+(high-low) /2 to reach the middle
-   uint32_t mid = low + ((high - low) / 2);  // Note: not (low + high) / 2 !!
-
-   //if the value at sum is higher than the value we are searching
-   //decrease the higher limit and record this value
-   //if a smaller indes is not found then this mid index is the right one
-   if (info->sum[mid] > value){
-        *res = mid;
-        return search(info, value, low, mid-1, res);
-   }
-   else {
-
-	 //if the value at sum is lower than the expected value then
-	 //increas the lower limit and search
-     if (info->sum[mid] < value)
-        return search(info, value, mid+1, high, res);
-
-     else
-    	//if it is equal the value then return mid+1 because
-    	//the value starts at 0 and that value
-        return mid+1; // found
-   }
-
-
-}
-
+  //without runs the content ids are independent and drawn in batches
+  if(conf->nrunlength==0){
+    if(stat->ids_left==0){
+      get_contentids(info, &stat->content_rng, stat->ids, RNG_BATCH);
+      stat->ids_left=RNG_BATCH;
+    }
+    return stat->ids[RNG_BATCH-stat->ids_left--];
+  }
 
-uint64_t get_contentid(struct duplicates_info *info){
+  uint64_t c = get_class(info, &stat->content_rng);
+  uint64_t id = get_class_contentid(info, &stat->content_rng, c);
 
-  //generates a random number between 0 and the total of blocks of the dataset
-  uint64_t r = genrand(info->total_blocks);
-  //printf("search for %d\n",r);
+  if(c<info->nclasses){
+    int r = rng_range(&stat->content_rng, 100);
+    int i;
+    for(i=0;i<conf->nrunlength-1 && r>=conf->runlength_perc[i];i++){
+      r-=conf->runlength_perc[i];
+    }
 
-  //if r is higher than the last value of sum then
-  //an unique block withouth duplicates is written
-  //the last value at sum is unique because the array starts at 0
-  if (info->duplicated_blocks<=0 || r>=info->sum[info->duplicated_blocks-1]) {
-      //r is equal to the unique counter for generating
-      // a block with unique content from the others generated previously
-      r = info->u_count;
-      //increment the counter...
-      info->u_count = info->u_count+1;
-      return r;
+    struct dup_class *cl = &info->classes[c];
+    stat->run_left = conf->runlength_len[i]-1;
+    stat->run_class = c;
+    stat->run_next_id = (id+1<cl->first_id+cl->nblocks) ? id+1 : cl->first_id;
   }
-  //the block to be generated has duplicated content
-  else {
 
-     //index of sum returned for generating the correct content for the block
-	 uint64_t ac =0;
-     //binary search for the index at sum where that
-     //r is the random value, 0 and duplicated_bloc are the range of positions at the sum array
-	 uint64_t res = search(info, r,0,info->duplicated_blocks-1,&ac);
-     //increase the number of duplicates
-
-     return res;
-  }
+  return id;
 }
 
 void get_block_content(char* bufaux, struct block_info infowrite, uint64_t block_size){
 
-  //initialize the buffer with duplicate content
-  int bufp = 0;
-  for(bufp=0;bufp<block_size;bufp++){
-    bufaux[bufp] = 'a';
-  }
-
-  if(infowrite.procid!=-1){
-    sprintf(bufaux,"%llu pid %d time %llu ", (long long unsigned int)infowrite.cont_id,infowrite.procid,(long long unsigned int)infowrite.ts);
-  }
-  else{
-    sprintf(bufaux,"%llu ", (long long unsigned int)infowrite.cont_id);
-  }
+  //binary header followed by a body that only depends on the block identity
+  //so that the same content is always generated
+  fill_block(bufaux, block_size, infowrite.cont_id, infowrite.procid, infowrite.ts);
 
 }
 
 void get_block_header(char* bufaux, struct block_info infowrite, uint64_t block_size){
 
-  if(infowrite.procid!=-1){
-    sprintf(bufaux,"%llu pid %d time %llu ", (long long unsigned int)infowrite.cont_id,infowrite.procid,(long long unsigned int)infowrite.ts);
-  }
-  else{
-    sprintf(bufaux,"%llu ", (long long unsigned int)infowrite.cont_id);
-  }
+  struct block_header hdr = {.magic=CONTENT_MAGIC, .procid=infowrite.procid, .cont_id=infowrite.cont_id, .ts=infowrite.ts};
+  memcpy(bufaux, &hdr, sizeof(struct block_header));
 
 }
 
+//checks if the block is well built, i.e., its body matches the block described by its own header
 int check_block_content(char* buf, uint64_t block_size){
 
-  const char s[2] = " ";
-  char *token=NULL;
-  int contwrites_b=-1;
-  int times_b=-1;
-  uint64_t contwrites=0;
-  uint64_t times=0;
-  int pids=-1;
-
-  char original_buf[block_size];
-  memcpy(original_buf,buf, block_size);
-
-  //initialize the buffer with duplicate content
-  int bufp = 0;
-  char bufaux[block_size];
-  for(bufp=0;bufp<block_size;bufp++){
-    bufaux[bufp] = 'a';
-  }
-   
-  token = strtok(original_buf, s);
-  /* walk through other tokens */
-  while( token != NULL ) 
-  {
-
-      if(contwrites_b<0){
-        contwrites = atoll(token);
-        contwrites_b=1;
-      }
+  struct block_header hdr;
+  memcpy(&hdr, buf, sizeof(struct block_header));
 
-      if(pids<0 && strcmp(token,"pid")==0){
-        token = strtok(NULL, s);
-        pids=atoi(token);
-        
-      }else{
-        if(times_b<0 && strcmp(token,"time")==0){
-          token = strtok(NULL, s);
-          times = atoll(token);
-          times_b=1;
-        }
-        else{
-          token = strtok(NULL, s);
-        }
-      }
-      
+  if(hdr.magic!=CONTENT_MAGIC){
+    return -1;
   }
 
-  if(contwrites_b >= 0 && pids>=0 && times_b >=0){
-    sprintf(bufaux,"%llu pid %d time %llu ", (long long unsigned int)contwrites,pids,(long long unsigned int)times);
-  }
-  else{
-    if(contwrites_b>=0){
-      sprintf(bufaux,"%llu ", (long long unsigned int)contwrites);
-    }
-    else{
-      return -1;
-    }
-  }
-    
-  return memcmp(buf,bufaux, block_size);
-   
+  return verify_block(buf, block_size, hdr.cont_id, hdr.procid, hdr.ts);
 }
 
 
 int compare_blocks(char* buf, struct block_info infowrite, uint64_t block_size, FILE* fpi, int final_check){
 
-  char bufaux[block_size];
   int i=0;
-  get_block_content(bufaux, infowrite, block_size);
 
   // added to prevent errors, ask why ????
   // printf("%lu, %d, %lu\n", infowrite.cont_id, infowrite.procid, infowrite.ts);
@@ -409,7 +298,8 @@ int compare_blocks(char* buf, struct block_info infowrite, uint64_t block_size,
     return 0;
   }
 
-  if(memcmp(buf,bufaux,block_size)!=0){
+  //the block is checked in place, the expected block is never built
+  if(verify_block(buf, block_size, infowrite.cont_id, infowrite.procid, infowrite.ts)!=0){
     i=check_block_content(buf, block_size);
     if(i==0 && final_check==0){
       fprintf(fpi,"There was a mismatch regarding the last content written for the block is id %llu and the content read.\n", (long long unsigned int) infowrite.cont_id);
@@ -426,21 +316,15 @@ int compare_blocks(char* buf, struct block_info infowrite, uint64_t block_size,
 
 // Used to know the content of the next block that will be generated
 // Follows the duplicate distribution
-void get_writecontent(char *buf, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *info_write){
+void next_writecontent(struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *info_write){
   
   uint64_t contwrite;
   struct timeval tim;
 
-  //initialize the buffer with duplicate content
-  int bufp = 0;
-  for(bufp=0;bufp<conf->block_size;bufp++){
-    buf[bufp] = 'a';
-  }
-
   //TODO: Stats should be removed from here...
 
   //get the content
-  contwrite = get_contentid(info);
+  contwrite = get_contentid_run(info, conf, stat);
 
   //if the content to write is unique write to the buffer
   //the unique counter of the process + "string"  + process id
@@ -448,17 +332,23 @@ void get_writecontent(char *buf, struct user_confs *conf, struct duplicates_info
   //an identical number from other oprocess
   //timestamp is used for multiple DEDIS benchs to be different
   if(contwrite>=info->duplicated_blocks){
-    //get current time for making this value unique for concurrent benchmarks
-    gettimeofday(&tim, NULL);
-    uint64_t tunique=tim.tv_sec*1000000+(tim.tv_usec);
-    sprintf(buf,"%llu pid %d time %llu ", (long long unsigned int)contwrite,idproc,(long long unsigned int)tunique);
+    uint64_t tunique;
+    if(conf->deterministic==1){
+      //the id already comes from the range of the process, the block only depends on
+      //(seed, process, sequence number) and can be regenerated (never 0, see tracked_block)
+      tunique=conf->seed+1;
+    }else{
+      //get current time for making this value unique for concurrent benchmarks
+      gettimeofday(&tim, NULL);
+      tunique=tim.tv_sec*1000000+(tim.tv_usec);
+    }
     stat->uni++;
     //uni referes to unique blocks meaning that
     // also counts 1 copy of each duplicated block
     //zerodups only refers to blocks with only one copy (no duplicates)
     stat->zerod++;
     if(conf->distout==1){
-      *info->zerodups=*info->zerodups+1;
+      count_unique(info);
     }
 
     info_write->cont_id=contwrite;
@@ -468,13 +358,97 @@ void get_writecontent(char *buf, struct user_confs *conf, struct duplicates_info
   //if it is duplicated write the result (index of sum) returned
   //into the buffer
   else{
-    sprintf(buf,"%llu ", (long long unsigned int)contwrite);
     info_write->cont_id=contwrite;
     info_write->procid=-1;
     info_write->ts=-1;
   }
 
+}
+
+void get_writecontent(char *buf, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *info_write){
+
+  next_writecontent(conf, info, stat, idproc, info_write);
+
+  //header with the content id (and process and time for unique blocks) followed by the body
+  get_block_content(buf, *info_write, conf->block_size);
+
+}
+
+
+//unique content ids of worker w are taken from its own range, so that processes never
+//generate the same id (processes are numbered from 1, the population of the file of
+//process i is worker nprocs+1+i)
+void init_unique_ids(struct duplicates_info *info, int w){
+
+  info->u_count = info->duplicated_blocks+1+((uint64_t) w<<UID_RANGE_BITS);
+}
+
+//process written in the header of the unique block cont_id, given by the range of its id
+//(the population writes its blocks as process 0)
+int unique_procid(struct duplicates_info *info, struct user_confs *conf, uint64_t cont_id){
+
+  uint64_t w = (cont_id-info->duplicated_blocks-1)>>UID_RANGE_BITS;
+
+  return (w>=1 && w<=conf->nprocs) ? w-1 : 0;
+}
+
+//duplicates written by a process are counted in a private shard (untouched pages are
+//never allocated) instead of the shared statistics, processes merge it when they end
+void init_dup_shard(struct duplicates_info *info){
+
+  info->dup_shard=NULL;
+  info->zerodups_shard=0;
+
+  if(info->statistics){
+    info->dup_shard=calloc(info->duplicated_blocks, sizeof(uint64_t));
+    if(!info->dup_shard){
+      perror("Error allocating duplicate counters");
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+//count a new copy of duplicated content id and return the number of copies known
+//by the process (the ones written before the benchmark started plus its own)
+uint64_t count_duplicate(struct duplicates_info *info, uint64_t id){
+
+  if(info->dup_shard){
+    info->dup_shard[id]++;
+    return info->statistics[id]+info->dup_shard[id];
+  }
+
+  info->statistics[id]++;
+  return info->statistics[id];
+}
+
+//count a block without duplicates
+void count_unique(struct duplicates_info *info){
+
+  if(info->dup_shard){
+    info->zerodups_shard++;
+  }else{
+    *info->zerodups=*info->zerodups+1;
+  }
+}
+
+void merge_dup_shard(struct duplicates_info *info){
+
+  uint64_t i;
+
+  if(info->dup_shard){
+    for(i=0;i<info->duplicated_blocks;i++){
+      if(info->dup_shard[i]>0){
+        __atomic_fetch_add(&info->statistics[i], info->dup_shard[i], __ATOMIC_RELAXED);
+      }
+    }
+    free(info->dup_shard);
+    info->dup_shard=NULL;
+  }
 
+  if(info->zerodups_shard>0){
+    __atomic_fetch_add(info->zerodups, info->zerodups_shard, __ATOMIC_RELAXED);
+    info->zerodups_shard=0;
+  }
 }
 
 
@@ -13,12 +13,42 @@
 #define HEADF "results/headers"
 
 
+//probabilities of the alias table are scaled to this value
+#define ALIAS_SCALE (1ULL<<32)
+
+//each process generates unique content ids from its own range of 2^UID_RANGE_BITS ids
+#define UID_RANGE_BITS 40
+
 struct block_info{
 	uint64_t cont_id;
 	int procid;
 	uint64_t ts;
 };
 
+//distinct blocks with the same number of duplicates (a line of the distribution file)
+struct dup_class{
+	//occurrences of each block in the class
+	uint64_t dups;
+	//number of distinct blocks in the class
+	uint64_t nblocks;
+	//content id of the first block of the class, the others follow it
+	uint64_t first_id;
+};
+
+//entry of the Walker/Vose alias table used to pick the class of a new block
+struct alias_entry{
+	//probability (scaled to ALIAS_SCALE) of picking this entry instead of its alias
+	uint64_t prob;
+	uint64_t alias;
+};
+
+//tables used to sample the content of new blocks (one for each phase of the schedule)
+struct dup_sampler{
+	struct dup_class *classes;
+	uint64_t nclasses;
+	struct alias_entry *alias;
+};
+
 struct duplicates_info{
 
 	//Number of distinct content blocks with duplicates
@@ -27,16 +57,23 @@ struct duplicates_info{
 	//TOtal Number of blocks at the data set
 	uint64_t total_blocks;
 
-	//array with data collected from Homer (for each duplicated block, the amount of duplicates)
-	//for homer 1839041
-	uint64_t *stats;
-
-	//array cumulative value of stats sum[n] = stats[n]+sum[n-1] used for having
-	//distribution for duplicate generation
-	uint64_t *sum;
-	//[1839041];
-
+	//number of times each duplicated content was written (only for dist_results and faults)
 	uint64_t *statistics;
+	//copies written by this process, added to statistics and zerodups when it ends
+	uint64_t *dup_shard;
+	uint64_t zerodups_shard;
+
+	//distribution loaded from the file (e.g. for homer 1839041 duplicated blocks in a few
+	//hundred classes), a content id is mapped to its class arithmetically with first_id.
+	//classes[nclasses] are the blocks without duplicates
+	//alias table has one entry per class plus a last entry for blocks without duplicates
+	struct dup_class *classes;
+	uint64_t nclasses;
+	struct alias_entry *alias;
+
+	//sampler tables of the phases of the workload schedule (see benchcore/phases),
+	//the active phase is copied to classes, nclasses and alias
+	struct dup_sampler *phases;
 
 	//shared mem
 	uint64_t *zerodups;
@@ -50,9 +87,12 @@ struct duplicates_info{
   	//starts with value==max index at array sum
   	//since duplicated content is identified by number correspondent to the indexes at sum
   	//none will have a identifier bigger than this
+  	//each process starts at its own range (see init_unique_ids)
   	uint64_t u_count;
 
   	struct block_info **content_tracker;
+  	//compact tracker, 64 bits per block (see benchcore/tracker)
+  	uint64_t **content_refs;
   
   	uint64_t topblock;
   	uint64_t botblock;
@@ -62,12 +102,25 @@ struct duplicates_info{
   	struct block_info last_block_written;
 };
 
-void get_distribution_stats(struct duplicates_info *info, char* fname);
-void load_duplicates(struct duplicates_info *info, char* fname);
-void load_cumulativedist(struct duplicates_info *info, int distout);
-uint64_t search(struct duplicates_info *info, uint64_t value,int low, int high, uint64_t *res);
+void load_distribution(struct duplicates_info *info, char* fname);
+void load_alias_table(struct duplicates_info *info);
+uint64_t get_contentid(struct duplicates_info *info, struct rng *rng);
+//n content ids drawn ahead of time (without runs of duplicated blocks)
+void get_contentids(struct duplicates_info *info, struct rng *rng, uint64_t *ids, uint64_t n);
+int init_runlengths(struct user_confs *conf);
+uint64_t get_contentid_run(struct duplicates_info *info, struct user_confs *conf, struct stats *stat);
+//identity of the next block written, without generating it (see get_block_content)
+void next_writecontent(struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *info_write);
 void get_writecontent(char *buf, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *info_write);
+void init_unique_ids(struct duplicates_info *info, int w);
+int unique_procid(struct duplicates_info *info, struct user_confs *conf, uint64_t cont_id);
+void init_dup_shard(struct duplicates_info *info);
+uint64_t count_duplicate(struct duplicates_info *info, uint64_t id);
+void count_unique(struct duplicates_info *info);
+void merge_dup_shard(struct duplicates_info *info);
 int gen_outputdist(struct duplicates_info *info, DB **dbpor,DB_ENV **envpor);
+//0 if the body of the block matches its own header
+int check_block_content(char* buf, uint64_t block_size);
 int compare_blocks(char* buf, struct block_info infowrite, uint64_t block_size, FILE* fpi, int finalcheck);
 void get_block_content(char* bufaux, struct block_info infowrite, uint64_t block_size);
 void get_block_header(char* bufaux, struct block_info infowrite, uint64_t block_size);
@@ -12,13 +12,14 @@
 
 #include "../duplicates/duplicatedist.h"
 
-int socket;
+//named and static so that it does not shadow socket() of libc for the rest of the benchmark
+static int fsp_sock;
 int socket_inited;
 
 void fault_init(){
-  socket = fsp_socket();
-  if(socket >= 0){
-    fsp_connect(socket);
+  fsp_sock = fsp_socket();
+  if(fsp_sock >= 0){
+    fsp_connect(fsp_sock);
     socket_inited = 1;
   } else {
     socket_inited = -1;
@@ -110,17 +111,17 @@ int inject_fault(Fault_Conf fault, Dedup_Degree dd, uint32_t block_size, struct
   int res; 
   switch(fault->mode){
     case FBD_MODE_HASH:
-      res = fsp_add_generic_hash(socket, block_size, block, fault->operation, fault->fault_type, 
+      res = fsp_add_generic_hash(fsp_sock, block_size, block, fault->operation, fault->fault_type, 
                                               fault->persistent, FBD_HASH_XXH3_128, 
                                               fault_extra, fault_extra_size);
       break;
     case FBD_MODE_BLOCK:
-      res = fsp_add_generic_block(socket, block_size, offset, fault->operation,
+      res = fsp_add_generic_block(fsp_sock, block_size, offset, fault->operation,
                                               fault->fault_type, fault->persistent, 
                                               fault_extra, fault_extra_size);
       break;
     case FBD_MODE_DEDUP:
-      res = fsp_add_generic_dedup(socket, block_size, block, fault->operation, fault->fault_type, 
+      res = fsp_add_generic_dedup(fsp_sock, block_size, block, fault->operation, fault->fault_type, 
                                               fault->persistent, FBD_HASH_XXH3_128, 
                                               fault_extra, fault_extra_size);
       break;
@@ -227,11 +228,11 @@ int fault_split(char* a_str, struct user_confs *conf){
 }
 
 
-	void define_failure_per_process(struct user_confs *conf){
+	void define_failure_per_process(struct user_confs *conf, struct rng *rng){
 	int i;
 
 	for(i =0; i<conf->nr_faults;i++){
-		conf->fconf[i].proc_id=genrand(conf->nr_proc_w);
+		conf->fconf[i].proc_id=rng_range(rng, conf->nr_proc_w);
 	}
 }
 
@@ -325,7 +326,7 @@ struct block_info* finfo_get_last_block(Faults_Info fi, int procid){
 }
 
 void remove_all_fauls(){
-  fsp_remove_all_faults(socket);
+  fsp_remove_all_faults(fsp_sock);
 }
 
 /*int main(int argc, char** argv){
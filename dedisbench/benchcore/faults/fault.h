@@ -61,7 +61,7 @@ void init_fault_statistics(struct faults_statistics *fstats);
 int inject_failure(int fault_type, int fault_dist, struct duplicates_info *info, uint64_t block_size, struct user_confs* conf);
 int inject_fault(Fault_Conf fault, Dedup_Degree dd, uint32_t block_size, struct faults_info *f_info, 
                   struct faults_statistics *fstats, int procid, uint64_t offset);
-                  void define_failure_per_process(struct user_confs *conf);
+                  void define_failure_per_process(struct user_confs *conf, struct rng *rng);
 #define decr_fault_conf_index(finfo, procid) finfo->faults->ifaults[procid] = finfo->faults->ifaults[procid]-1
 Fault_Conf next_fault_conf(Fault_Runtime runtime, int procid, uint64_t n_ops, uint64_t time_elapsed);
 void print_fault_conf(Fault_Conf fc);
@@ -0,0 +1,351 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include "integrity.h"
+#include "../tracker/tracker.h"
+#include "../content/content.h"
+#include "../../utils/timing/timing.h"
+
+
+//range of blocks [first, last[ verified by a thread
+struct scan_range{
+	struct user_confs *conf;
+	struct duplicates_info *info;
+	int idproc;
+
+	//O_DIRECT descriptor (-1 if not supported) and buffered one
+	int dfd;
+	int fd;
+
+	uint64_t first;
+	uint64_t last;
+
+	//errors of the range, appended to the results file once every thread ends
+	FILE *log;
+	char *logbuf;
+	size_t loglen;
+	int errors;
+
+	//blocks verified by every thread and threads that ended
+	uint64_t *scanned;
+	int *done;
+};
+
+
+int integrity_threads(struct user_confs *conf){
+
+	int n = conf->integrity_threads;
+
+	if(n<=0){
+		n = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	return (n>0) ? n : 1;
+}
+
+//read len bytes at off, direct reads that the file does not accept are done through the page cache
+static int64_t scan_read(struct scan_range *r, char *buf, uint64_t len, uint64_t off){
+
+	int64_t res=-1;
+
+	if(r->dfd!=-1){
+		res = pread(r->dfd, buf, len, off);
+		if(res!=-1 || errno!=EINVAL){
+			return res;
+		}
+	}
+	return pread(r->fd, buf, len, off);
+}
+
+static void* scan_thread(void *arg){
+
+	struct scan_range *r = (struct scan_range *) arg;
+	struct user_confs *conf = r->conf;
+	uint64_t bs = conf->block_size;
+	uint64_t chunk = (INTEGRITY_CHUNK>bs) ? INTEGRITY_CHUNK/bs : 1;
+	uint64_t blk = r->first, end, b;
+	char *buf;
+
+	if(posix_memalign((void **) &buf, 4096, chunk*bs)!=0){
+		perror("Error allocating integrity scan buffer");
+		exit(EXIT_FAILURE);
+	}
+	posix_fadvise(r->fd, r->first*bs, (r->last-r->first)*bs, POSIX_FADV_SEQUENTIAL);
+
+	while(blk<r->last){
+		uint64_t start=blk;
+
+		//blocks never written are not read
+		while(blk<r->last && !tracked_block(r->info, r->idproc, blk)){
+			blk++;
+		}
+		if(blk<r->last){
+			end = (blk+chunk<r->last) ? blk+chunk : r->last;
+			while(!tracked_block(r->info, r->idproc, end-1)){
+				end--;
+			}
+
+			int64_t res = scan_read(r, buf, (end-blk)*bs, blk*bs);
+			uint64_t nread = (res>0) ? res/bs : 0;
+
+			for(b=blk;b<end;b++){
+				if(!tracked_block(r->info, r->idproc, b)){
+					continue;
+				}
+				if(b-blk>=nread){
+					fprintf(r->log, "Reading block in offset %llu, with size %llu returned %lld. Maybe the files was not populated correctly?\n",
+						(unsigned long long int) (b*bs), (unsigned long long int) bs, (long long int) res);
+					r->errors++;
+					continue;
+				}
+				r->errors+=check_tracked_block(conf, r->info, r->idproc, b, buf+(b-blk)*bs, r->log, 1);
+			}
+			if(nread<end-blk){
+				printf("Reading %llu bytes in offset %llu returned %lld. Maybe the files was not populated correctly?\n",
+					(unsigned long long int) ((end-blk)*bs), (unsigned long long int) (blk*bs), (long long int) res);
+			}
+			blk=end;
+		}
+
+		__atomic_add_fetch(r->scanned, blk-start, __ATOMIC_RELAXED);
+	}
+
+	free(buf);
+	__atomic_add_fetch(r->done, 1, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+int scan_integrity(const char *path, struct user_confs *conf, struct duplicates_info *info, int idproc, FILE *fpi){
+
+	uint64_t totb = conf->filesize/conf->block_size;
+	uint64_t chunk = (INTEGRITY_CHUNK>conf->block_size) ? INTEGRITY_CHUNK/conf->block_size : 1;
+	uint64_t nchunks = (totb+chunk-1)/chunk;
+	uint64_t scanned=0;
+	int done=0, errors=0, i;
+
+	int nthreads = integrity_threads(conf);
+	if(nthreads>nchunks){
+		nthreads = (nchunks>0) ? nchunks : 1;
+	}
+
+	int fd = open(path, O_RDONLY | O_LARGEFILE);
+	if(fd==-1){
+		perror("Error opening file for the integrity check");
+		exit(EXIT_FAILURE);
+	}
+	//the check reads what reached the storage, unless the file system has no O_DIRECT support
+	int dfd = open(path, O_RDONLY | O_LARGEFILE | O_DIRECT);
+
+	//ranges are made of whole chunks so that reads stay aligned
+	uint64_t per = ((nchunks+nthreads-1)/nthreads)*chunk;
+	struct scan_range ranges[nthreads];
+	pthread_t threads[nthreads];
+
+	for(i=0;i<nthreads;i++){
+		struct scan_range *r = &ranges[i];
+		bzero(r, sizeof(struct scan_range));
+		r->conf=conf;
+		r->info=info;
+		r->idproc=idproc;
+		r->dfd=dfd;
+		r->fd=fd;
+		r->first = (i*per<totb) ? i*per : totb;
+		r->last = (r->first+per<totb) ? r->first+per : totb;
+		r->scanned=&scanned;
+		r->done=&done;
+		r->log = open_memstream(&r->logbuf, &r->loglen);
+		if(!r->log){
+			perror("Error opening integrity scan log");
+			exit(EXIT_FAILURE);
+		}
+
+		if(pthread_create(&threads[i], NULL, scan_thread, r)!=0){
+			perror("Error launching integrity scan thread");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	uint64_t begin=now_ns(), last_report=begin;
+	while(__atomic_load_n(&done, __ATOMIC_ACQUIRE)<nthreads){
+		usleep(10000);
+
+		uint64_t now=now_ns();
+		if(now-last_report>=INTEGRITY_PROGRESS*1000000000ULL){
+			uint64_t s = __atomic_load_n(&scanned, __ATOMIC_RELAXED);
+			printf("Integrity check of %s: %.1f%% done (%.1f MB/s)\n", path, 100.0*s/totb,
+				(s*conf->block_size/(1024.0*1024.0))/((now-begin)/1.0e9));
+			last_report=now;
+		}
+	}
+
+	for(i=0;i<nthreads;i++){
+		pthread_join(threads[i], NULL);
+		fclose(ranges[i].log);
+		fwrite(ranges[i].logbuf, 1, ranges[i].loglen, fpi);
+		free(ranges[i].logbuf);
+		errors+=ranges[i].errors;
+	}
+
+	printf("Checked %s with %d threads in %.2f seconds\n", path, nthreads, (now_ns()-begin)/1.0e9);
+
+	if(dfd!=-1){
+		close(dfd);
+	}
+	close(fd);
+
+	return errors;
+}
+
+//verifies the bodies of the blocks read by the process
+static void* verifier_thread(void *arg){
+
+	struct verifier *v = (struct verifier *) arg;
+	uint64_t bs = v->conf->block_size;
+	uint64_t tail = v->tail, b;
+	struct block_header hdr;
+
+	while(1){
+		int stop = __atomic_load_n(&v->stop, __ATOMIC_ACQUIRE);
+		uint64_t head = __atomic_load_n(&v->head, __ATOMIC_ACQUIRE);
+
+		if(head==tail){
+			//the process only sets stop after submitting its last request
+			if(stop){
+				break;
+			}
+			usleep(100);
+			continue;
+		}
+
+		struct verify_slot *s = &v->ring[tail%VERIFY_RING];
+		for(b=0;b<s->nblocks;b++){
+			if(!s->body[b]){
+				continue;
+			}
+			//the header matched the tracker, the body must be the one of the header
+			char *blk = s->buf+b*bs;
+			memcpy(&hdr, blk, sizeof(struct block_header));
+			if(verify_block_body(blk+sizeof(struct block_header), bs-sizeof(struct block_header), content_key(hdr.cont_id, hdr.procid, hdr.ts))!=0){
+				fprintf(v->fpi, "Error checking integrity for block with contentid %llu\n", (long long unsigned int) hdr.cont_id);
+				__atomic_add_fetch(&v->errors, 1, __ATOMIC_RELAXED);
+			}
+		}
+
+		tail++;
+		//release the slot to the process
+		__atomic_store_n(&v->tail, tail, __ATOMIC_RELEASE);
+	}
+
+	return NULL;
+}
+
+static void slot_alloc(struct verifier *v, struct verify_slot *s, uint64_t size){
+
+	free(s->buf);
+	free(s->body);
+	//aligned for O_DIRECT
+	if(posix_memalign((void **) &s->buf, 4096, size)!=0){
+		perror("Error allocating integrity verifier buffer");
+		exit(EXIT_FAILURE);
+	}
+	s->body=malloc(size/v->conf->block_size);
+	s->size=size;
+}
+
+struct verifier* verifier_start(struct user_confs *conf, FILE *fpi){
+
+	int i;
+	struct verifier *v;
+
+	if(posix_memalign((void **) &v, 64, sizeof(struct verifier))!=0){
+		perror("Error allocating integrity verifier");
+		exit(EXIT_FAILURE);
+	}
+	bzero(v, sizeof(struct verifier));
+	v->conf=conf;
+	v->fpi=fpi;
+
+	for(i=0;i<VERIFY_RING;i++){
+		slot_alloc(v, &v->ring[i], conf->max_request_size);
+	}
+
+	if(pthread_create(&v->thread, NULL, verifier_thread, v)!=0){
+		perror("Error launching integrity verifier thread");
+		exit(EXIT_FAILURE);
+	}
+
+	return v;
+}
+
+char* verifier_buffer(struct verifier *v, uint64_t size){
+
+	//the slot is free once the thread verified the request that used it before
+	while(v->head-__atomic_load_n(&v->tail, __ATOMIC_ACQUIRE)>=VERIFY_RING){
+		sched_yield();
+	}
+
+	struct verify_slot *s = &v->ring[v->head%VERIFY_RING];
+	//requests of replayed traces may be larger than max_request_size
+	if(s->size<size){
+		slot_alloc(v, s, size);
+	}
+
+	return s->buf;
+}
+
+int verify_read(struct verifier *v, struct duplicates_info *info, int pos, uint64_t blk, uint64_t nblocks){
+
+	struct verify_slot *s = &v->ring[v->head%VERIFY_RING];
+	uint64_t bs = v->conf->block_size, b;
+	int errors=0;
+
+	s->nblocks=nblocks;
+	for(b=0;b<nblocks;b++){
+		int res = check_tracked_header(v->conf, info, pos, blk+b, s->buf+b*bs);
+		s->body[b] = (res==0);
+		//mismatches are rare, the whole block is checked right away to report them
+		if(res==1){
+			errors+=check_tracked_block(v->conf, info, pos, blk+b, s->buf+b*bs, v->fpi, 0);
+		}
+	}
+
+	//publish the request to the thread
+	__atomic_store_n(&v->head, v->head+1, __ATOMIC_RELEASE);
+
+	return errors;
+}
+
+int verifier_errors(struct verifier *v){
+
+	return __atomic_load_n(&v->errors, __ATOMIC_RELAXED);
+}
+
+int verifier_stop(struct verifier *v){
+
+	int i;
+
+	__atomic_store_n(&v->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(v->thread, NULL);
+
+	int errors=v->errors;
+	for(i=0;i<VERIFY_RING;i++){
+		free(v->ring[i].buf);
+		free(v->ring[i].body);
+	}
+	free(v);
+
+	return errors;
+}
@@ -0,0 +1,76 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef INTEGRITY_H
+#define INTEGRITY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../duplicates/duplicatedist.h"
+#include "../../structs/defines.h"
+
+//Static integrity check of a file (or device): the blocks are split in disjoint ranges,
+//one per thread, and each thread reads its range sequentially in large chunks (with
+//O_DIRECT when the file system supports it) and verifies the blocks in place
+
+//size of each read of the scan
+#define INTEGRITY_CHUNK (4*1024*1024)
+//seconds between progress reports
+#define INTEGRITY_PROGRESS 5
+
+//number of threads used by the scan (integrity_threads option, 0 for one per CPU)
+int integrity_threads(struct user_confs *conf);
+
+//verify the blocks tracked for file idproc (see benchcore/tracker) against the content
+//of path, errors are reported to fpi in the order of the blocks
+//returns the number of integrity errors
+int scan_integrity(const char *path, struct user_confs *conf, struct duplicates_info *info, int idproc, FILE *fpi);
+
+
+//Online integrity check of reads (integrity>=2): the headers of the blocks read are compared
+//with the tracker in the I/O loop, the bodies are verified by a thread of the process.
+//Requests are read into the buffers of a ring shared with the thread, the I/O loop only
+//waits for it when VERIFY_RING requests are pending.
+#define VERIFY_RING 16
+
+struct verify_slot{
+	char *buf;
+	uint64_t size;
+	uint64_t nblocks;
+	//blocks whose body is verified by the thread (header matched the tracker)
+	uint8_t *body;
+};
+
+struct verifier{
+	struct user_confs *conf;
+	FILE *fpi;
+	struct verify_slot ring[VERIFY_RING];
+	//requests submitted by the process and verified by the thread
+	uint64_t head;
+	uint64_t tail;
+	int stop;
+	//errors found by the thread
+	int errors;
+	pthread_t thread;
+};
+
+struct verifier* verifier_start(struct user_confs *conf, FILE *fpi);
+
+//buffer for the next read of size bytes, waits for the thread if the ring is full
+char* verifier_buffer(struct verifier *v, uint64_t size);
+
+//check the headers of the nblocks blocks read into the last buffer against the tracker
+//(pos, starting at block blk) and hand the buffer to the thread
+//returns the errors found in the headers, reported to fpi as check_tracked_block
+int verify_read(struct verifier *v, struct duplicates_info *info, int pos, uint64_t blk, uint64_t nblocks);
+
+//errors found by the thread so far
+int verifier_errors(struct verifier *v);
+
+//wait for the pending requests and end the thread, returns the errors it found
+int verifier_stop(struct verifier *v);
+
+#endif
@@ -3,33 +3,134 @@
  * Written by J. Paulo
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "io.h"
 #include "../utils/random/random.h"
+#include "../utils/utils.h"
 
 
 
-int init_io(struct user_confs *conf, int procid){
+int init_io(struct user_confs *conf, struct stats *stat, int procid){
 
   //init random generator
   //if the seed is always the same the generator generates the same numbers
   //for each proces the seed = seed + processid or all the processes would
   //generate the same load
-  init_rand(conf->seed+procid);
+  seed_rngs(stat, conf->seed+procid);
 
-  init_ioposition(conf);
+  init_ioposition(conf, &stat->rng);
 
   return 0;
 }
 
-uint64_t write_request(char* buf, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *infowrite){
+//the content ids come from a stream of the same seed that never overlaps the one of the
+//request sizes and offsets, so each can be drawn ahead of time without changing the other
+void seed_rngs(struct stats *stat, uint64_t seed){
 
-  get_writecontent(buf, conf, info, stat, idproc, infowrite);
+  rng_seed(&stat->rng, seed);
+  stat->content_rng=stat->rng;
+  rng_jump(&stat->content_rng);
+}
+
+//parse the bssplit option: size/percentage pairs separated by ':'
+//eg: 4k/50:64k/30:1m/20
+//must be called after the block size is known
+int init_request_sizes(struct user_confs *conf){
+
+  int i;
+  conf->max_request_size=conf->block_size;
+  conf->nbssplit=0;
+
+  if(strlen(conf->bssplit)==0){
+    return 0;
+  }
+
+  int n = parse_split(conf->bssplit, conf->bssplit_size, conf->bssplit_perc, BSSPLIT_MAX);
+  if(n<0){
+    printf("wrong bssplit option\n");
+    return -1;
+  }
+
+  for(i=0;i<n;i++){
+    //requests are made of whole dedup units (blocks)
+    if(conf->bssplit_size[i]==0 || conf->bssplit_size[i]%conf->block_size!=0){
+      printf("bssplit request size %llu must be a multiple of the block size %llu\n",
+        (unsigned long long int) conf->bssplit_size[i], (unsigned long long int) conf->block_size);
+      return -1;
+    }
+    if(conf->bssplit_size[i]>conf->max_request_size){
+      conf->max_request_size=conf->bssplit_size[i];
+    }
+  }
+
+  conf->nbssplit=n;
+
+  printf("Request sizes:");
+  for(i=0;i<conf->nbssplit;i++){
+    printf(" %llu bytes (%d%%)", (unsigned long long int) conf->bssplit_size[i], conf->bssplit_perc[i]);
+  }
+  printf("\n");
+
+  return 0;
+}
+
+//size in bytes of the next request, following the bssplit distribution
+uint64_t get_request_size(struct user_confs *conf, struct rng *rng){
+
+  if(conf->nbssplit==0){
+    return conf->block_size;
+  }
+
+  int r = rng_range(rng, 100);
+  int i;
+  for(i=0;i<conf->nbssplit-1;i++){
+    if(r<conf->bssplit_perc[i]){
+      break;
+    }
+    r-=conf->bssplit_perc[i];
+  }
+
+  return conf->bssplit_size[i];
+}
+
+//the content of each block (dedup unit) of the request follows the duplicate distribution
+//infowrite must have one entry per block
+void write_content(char* buf, uint64_t nblocks, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *infowrite){
+
+  uint64_t i;
+
+  for(i=0;i<nblocks;i++){
+    get_writecontent(buf+i*conf->block_size, conf, info, stat, idproc, &infowrite[i]);
+  }
+}
+
+//content of the request and its offset
+uint64_t write_request(char* buf, uint64_t nblocks, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *infowrite){
+
+  uint64_t iooffset;
+  //a run of duplicated blocks started by a previous request is still being written
+  int inrun = stat->run_left>0;
+
+  write_content(buf, nblocks, conf, info, stat, idproc, infowrite);
+
+  if(inrun){
+    //the blocks of the run are written after the previous ones
+    iooffset = get_ioposition_next(conf, idproc, stat->run_offset, nblocks);
+  }else{
+    iooffset = get_ioposition(conf, stat, idproc, nblocks);
+  }
+
+  if(stat->run_left>0){
+    stat->run_offset = iooffset+nblocks*conf->block_size;
+  }
 
-  return get_ioposition(conf, stat, idproc);
+  return iooffset;
 }
 
-uint64_t read_request(struct user_confs *conf, struct stats *stat, int idproc){
+uint64_t read_request(uint64_t nblocks, struct user_confs *conf, struct stats *stat, int idproc){
 
-  return get_ioposition(conf, stat, idproc);
+  return get_ioposition(conf, stat, idproc, nblocks);
 
 }
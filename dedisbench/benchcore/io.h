@@ -11,9 +11,13 @@
 #include "duplicates/duplicatedist.h"
 #include "../structs/defines.h"
 
-int init_io(struct user_confs *conf, int procid);
-uint64_t write_request(char* buf, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *infowrite);
-uint64_t read_request(struct user_confs *conf, struct stats *stat, int idproc);
+int init_io(struct user_confs *conf, struct stats *stat, int procid);
+void seed_rngs(struct stats *stat, uint64_t seed);
+int init_request_sizes(struct user_confs *conf);
+uint64_t get_request_size(struct user_confs *conf, struct rng *rng);
+void write_content(char* buf, uint64_t nblocks, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *infowrite);
+uint64_t write_request(char* buf, uint64_t nblocks, struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int idproc, struct block_info *infowrite);
+uint64_t read_request(uint64_t nblocks, struct user_confs *conf, struct stats *stat, int idproc);
 
 
-#endif
\ No newline at end of file
+#endif
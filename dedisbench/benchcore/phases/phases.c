@@ -0,0 +1,161 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "phases.h"
+#include "../accesses/iodist.h"
+
+
+int phase_config(struct user_confs *conf, const char *section, const char *name, const char *value){
+
+	int p;
+	char end;
+
+	if(sscanf(section, "phase%d%c", &p, &end)!=1){
+		return 0;
+	}
+	if(p<0 || p>=PHASES_MAX){
+		printf("phase%d: phases must be numbered from 0 to %d\n", p, PHASES_MAX-1);
+		exit(0);
+	}
+
+	struct phase_conf *ph = &conf->phases[p];
+	if(p>=conf->nphases){
+		conf->nphases=p+1;
+	}
+
+	if(strcmp(name, "distfile")==0){
+		strcpy(ph->distfile, value);
+	}
+	else if(strcmp(name, "duration")==0){
+		ph->duration=atoll(value);
+	}
+	else if(strcmp(name, "ops")==0){
+		ph->ops=atoll(value);
+	}
+	else if(strcmp(name, "access_type")==0){
+		ph->accesstype = parse_access_type(value);
+		if(ph->accesstype<0){
+			printf("phase%d: unknown type of pattern access for I/O operations\n", p);
+			exit(0);
+		}
+	}
+	else{
+		printf("phase%d: unknown option %s\n", p, name);
+		exit(0);
+	}
+
+	return 1;
+}
+
+int check_phases(struct user_confs *conf){
+
+	int p;
+
+	for(p=0;p<conf->nphases;p++){
+		if(strlen(conf->phases[p].distfile)==0){
+			printf("phase%d: missing distfile\n", p);
+			return -1;
+		}
+		//the last phase lasts until the end of the benchmark
+		if(p<conf->nphases-1 && conf->phases[p].duration==0 && conf->phases[p].ops==0){
+			printf("phase%d: missing duration or ops\n", p);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void load_phases(struct user_confs *conf, struct duplicates_info *info){
+
+	int p;
+	uint64_t c;
+
+	if(conf->nphases==0){
+		return;
+	}
+
+	info->phases=malloc(sizeof(struct dup_sampler)*conf->nphases);
+	if(!info->phases){
+		perror("Error allocating phases");
+		exit(EXIT_FAILURE);
+	}
+
+	for(p=0;p<conf->nphases;p++){
+
+		struct duplicates_info pinfo;
+		bzero(&pinfo, sizeof(struct duplicates_info));
+
+		printf("loading duplicates distribution %s for phase %d...\n", conf->phases[p].distfile, p);
+		load_distribution(&pinfo, conf->phases[p].distfile);
+		load_alias_table(&pinfo);
+
+		//ids of the duplicated content of the phase must not collide with the ids of
+		//the main distribution and previous phases
+		for(c=0;c<pinfo.nclasses;c++){
+			pinfo.classes[c].first_id+=info->duplicated_blocks;
+		}
+		info->duplicated_blocks+=pinfo.duplicated_blocks;
+
+		info->phases[p].classes=pinfo.classes;
+		info->phases[p].nclasses=pinfo.nclasses;
+		info->phases[p].alias=pinfo.alias;
+	}
+
+	//unique ids go after the duplicated ids of every distribution
+	info->u_count=info->duplicated_blocks+1;
+}
+
+//the sampler tables are built before forking, switching the phase of a process only
+//changes which ones it uses, so every block is sampled either from the old or the new phase
+static void set_phase(struct user_confs *conf, struct duplicates_info *info, struct stats *stat, int p, uint64_t now){
+
+	struct phase_conf *ph = &conf->phases[p];
+
+	info->classes=info->phases[p].classes;
+	info->nclasses=info->phases[p].nclasses;
+	info->alias=info->phases[p].alias;
+
+	if(ph->accesstype>0){
+		conf->accesstype=ph->accesstype;
+	}
+
+	//runs of duplicates and content ids drawn ahead refer to classes of the previous phase
+	stat->run_left=0;
+	stat->ids_left=0;
+
+	stat->phase=p;
+	stat->phase_ops=0;
+	stat->phase_end=(ph->duration>0) ? now+ph->duration*1000000000ULL : UINT64_MAX;
+}
+
+int update_phase(struct user_confs *conf, struct duplicates_info *info, struct stats *stat, uint64_t now){
+
+	if(conf->nphases==0){
+		return 0;
+	}
+
+	//first operation of the benchmark
+	if(stat->phase_end==0){
+		set_phase(conf, info, stat, 0, now);
+		return 1;
+	}
+
+	if(stat->phase==conf->nphases-1){
+		return 0;
+	}
+
+	struct phase_conf *ph = &conf->phases[stat->phase];
+	if(now>=stat->phase_end || (ph->ops>0 && stat->phase_ops>=ph->ops)){
+		set_phase(conf, info, stat, stat->phase+1, now);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,30 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef PHASES_H
+#define PHASES_H
+
+#include <stdint.h>
+#include "../../structs/defines.h"
+#include "../duplicates/duplicatedist.h"
+
+//parse a key of a [phase<N>] section of the configuration file
+//returns 1 if the section is a phase, 0 otherwise
+int phase_config(struct user_confs *conf, const char *section, const char *name, const char *value);
+
+//check the schedule, returns -1 if a phase is missing or never ends
+int check_phases(struct user_confs *conf);
+
+//load the distribution and build the sampler tables of every phase, must be called
+//after load_distribution for the main distribution and before loadmmap,
+//content ids of each phase follow the ones of the previous distributions
+void load_phases(struct user_confs *conf, struct duplicates_info *info);
+
+//switch the process to the next phase when the current one ends (and to the first
+//one at the beginning of the benchmark), now is the current time in nanoseconds
+//returns 1 if the phase changed
+int update_phase(struct user_confs *conf, struct duplicates_info *info, struct stats *stat, uint64_t now);
+
+#endif
@@ -0,0 +1,90 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#include <stdio.h>
+#include "regions.h"
+
+
+static uint64_t gcd(uint64_t a, uint64_t b){
+	while(b>0){
+		uint64_t t=a%b;
+		a=b;
+		b=t;
+	}
+	return a;
+}
+
+int init_regions(struct user_confs *conf){
+
+	if(conf->rawdevice==0){
+		conf->region_stride=0;
+		conf->region_blocks=conf->totblocks;
+		conf->region_last=0;
+		return 0;
+	}
+
+	//readers of mixed workloads address the regions of the writers
+	int workers = (conf->mixedIO==1) ? conf->nprocs/2 : conf->nprocs;
+	uint64_t align = (conf->region_align>0) ? conf->region_align : conf->block_size;
+
+	if(align%conf->block_size!=0){
+		printf("region_align must be a multiple of the block size\n");
+		return -1;
+	}
+	if(conf->region_overlap<0 && conf->region_overlap!=REGION_SHARED){
+		printf("region_overlap must be a percentage or 'all'\n");
+		return -1;
+	}
+
+	//blocks of the alignment that are also a multiple of REGION_LINE_BLOCKS
+	uint64_t ablocks = align/conf->block_size;
+	ablocks = ablocks/gcd(ablocks, REGION_LINE_BLOCKS)*REGION_LINE_BLOCKS;
+
+	uint64_t usable = (conf->totblocks/ablocks)*ablocks;
+	uint64_t stride = (conf->totblocks/workers/ablocks)*ablocks;
+	if(stride==0){
+		printf("the raw device has less than %llu aligned blocks for each of the %d workers\n",
+			(unsigned long long int) ablocks, workers);
+		return -1;
+	}
+
+	uint64_t nblocks = usable;
+	if(conf->region_overlap!=REGION_SHARED){
+		uint64_t overlap = (stride*conf->region_overlap/100/ablocks)*ablocks;
+		if(stride+overlap<usable){
+			nblocks=stride+overlap;
+		}
+	}
+
+	//the last writer of a block shared by several workers is not known
+	if(nblocks>stride && conf->integrity>0){
+		printf("integrity checks cannot be used with overlapping regions (region_overlap)\n");
+		return -1;
+	}
+
+	conf->region_stride=stride;
+	conf->region_blocks=nblocks;
+	conf->region_last=usable-nblocks;
+
+	printf("Raw device regions: %d workers with %llu blocks each, starting every %llu blocks (aligned to %llu blocks)\n",
+		workers, (unsigned long long int) nblocks, (unsigned long long int) stride, (unsigned long long int) ablocks);
+
+	return 0;
+}
+
+uint64_t region_blocks(struct user_confs *conf){
+
+	return conf->region_blocks;
+}
+
+uint64_t region_first(struct user_confs *conf, int idproc){
+
+	if(conf->rawdevice==0){
+		return 0;
+	}
+
+	uint64_t first = conf->region_stride*idproc;
+	return (first<conf->region_last) ? first : conf->region_last;
+}
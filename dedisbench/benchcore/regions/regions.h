@@ -0,0 +1,36 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef REGIONS_H
+#define REGIONS_H
+
+#include <stdint.h>
+#include "../../structs/defines.h"
+
+//Regions of the raw device addressed by each worker (files are addressed whole)
+//Regions start every region_stride blocks and have region_blocks blocks, both multiples of
+//the alignment (region_align option, eg: erase block, RAID stripe or zone size). With
+//region_overlap each region also covers that percentage of the next ones, the last regions
+//are moved back so that they end within the device. All regions have the same size.
+//The device shares a single integrity tracker indexed by block, regions start at a multiple
+//of REGION_LINE_BLOCKS so that workers never write tracker entries of the same cache line.
+
+//blocks whose tracker entries fill whole cache lines (8 bytes compact, 24 bytes full)
+#define REGION_LINE_BLOCKS 8
+
+//region_overlap value of regions that cover the whole device
+#define REGION_SHARED -1
+
+//plan the regions of the raw device, conf->totblocks must be set
+//returns -1 if the options cannot be used
+int init_regions(struct user_confs *conf);
+
+//blocks addressed by each worker
+uint64_t region_blocks(struct user_confs *conf);
+
+//first block addressed by worker idproc
+uint64_t region_first(struct user_confs *conf, int idproc);
+
+#endif
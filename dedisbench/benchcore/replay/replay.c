@@ -0,0 +1,398 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "replay.h"
+#include "../regions/regions.h"
+
+
+//make the bytes [pos, pos+len[ of the trace available, moving the mmap window if needed
+//returns NULL if they go beyond the end of the file
+static char* replay_map(struct replay_reader *rr, uint64_t pos, uint64_t len){
+
+	if(pos+len>rr->fsize){
+		return NULL;
+	}
+
+	if(rr->window==NULL || pos<rr->window_off || pos+len>rr->window_off+rr->window_len){
+		if(rr->window){
+			munmap(rr->window, rr->window_len);
+			rr->window=NULL;
+		}
+
+		uint64_t off = pos & ~((uint64_t) sysconf(_SC_PAGESIZE)-1);
+		rr->window_len = REPLAY_WINDOW_SIZE;
+		if(off+rr->window_len>rr->fsize){
+			rr->window_len=rr->fsize-off;
+		}
+
+		rr->window = mmap(NULL, rr->window_len, PROT_READ, MAP_SHARED, rr->fd, off);
+		if(rr->window==MAP_FAILED){
+			perror("Error mmapping replay trace");
+			exit(EXIT_FAILURE);
+		}
+		madvise(rr->window, rr->window_len, MADV_SEQUENTIAL);
+		rr->window_off=off;
+	}
+
+	return rr->window+(pos-rr->window_off);
+}
+
+static void parse_error(struct replay_reader *rr, const char *msg){
+
+	printf("%s line %llu: %s\n", rr->fname, (unsigned long long int) rr->line, msg);
+	exit(0);
+}
+
+static void skip_blanks(const char **p, const char *end){
+
+	while(*p<end && (**p==' ' || **p=='\t' || **p=='\r')){
+		(*p)++;
+	}
+}
+
+//fields are separated by a comma and/or blanks
+static void skip_separator(const char **p, const char *end){
+
+	skip_blanks(p, end);
+	if(*p<end && **p==','){
+		(*p)++;
+		skip_blanks(p, end);
+	}
+}
+
+static int parse_u64(const char **p, const char *end, uint64_t *v){
+
+	const char *s=*p;
+	*v=0;
+	while(*p<end && isdigit((unsigned char) **p)){
+		*v=*v*10+(**p-'0');
+		(*p)++;
+	}
+	return *p>s;
+}
+
+//seconds with an optional fraction, converted to ns without going through a double
+static int parse_seconds(const char **p, const char *end, uint64_t *ns){
+
+	uint64_t sec, frac=0, scale=1000000000ULL;
+
+	if(!parse_u64(p, end, &sec)){
+		return 0;
+	}
+	if(*p<end && **p=='.'){
+		(*p)++;
+		while(*p<end && isdigit((unsigned char) **p)){
+			if(scale>1){
+				scale/=10;
+				frac+=(**p-'0')*scale;
+			}
+			(*p)++;
+		}
+	}
+	*ns=sec*1000000000ULL+frac;
+	return 1;
+}
+
+//parse a line of a text trace, returns 1 if it is a read or write request
+static int parse_line(struct replay_reader *rr, const char *p, const char *end, struct replay_record *rec){
+
+	skip_blanks(&p, end);
+	//empty lines and comments
+	if(p==end || *p=='#'){
+		return 0;
+	}
+	//column names
+	if(rr->line==1 && isalpha((unsigned char) *p)){
+		return 0;
+	}
+
+	uint64_t size;
+	if(!parse_u64(&p, end, &rec->offset)){
+		parse_error(rr, "offset must be a number");
+	}
+	skip_separator(&p, end);
+	if(!parse_u64(&p, end, &size)){
+		parse_error(rr, "size must be a number");
+	}
+	rec->size=size;
+	skip_separator(&p, end);
+
+	const char *opstr=p;
+	while(p<end && *p!=',' && *p!=' ' && *p!='\t'){
+		p++;
+	}
+	if(p==opstr){
+		parse_error(rr, "missing operation");
+	}
+	skip_separator(&p, end);
+
+	if(!parse_seconds(&p, end, &rec->ts_ns)){
+		parse_error(rr, "timestamp must be a number of seconds");
+	}
+	skip_blanks(&p, end);
+	if(p!=end){
+		parse_error(rr, "unexpected characters after the timestamp");
+	}
+
+	switch(*opstr){
+		case 'R': case 'r': rec->op=READ; break;
+		case 'W': case 'w': rec->op=WRITE; break;
+		default:
+			//discards, flushes and other operations are not replayed
+			return 0;
+	}
+
+	return size>0;
+}
+
+//next request of the trace (for every process), returns 0 at the end of the trace
+static int replay_read(struct replay_reader *rr, struct replay_record *rec){
+
+	if(rr->binary){
+		char *r = replay_map(rr, rr->pos, sizeof(struct replay_record));
+		if(r==NULL){
+			return 0;
+		}
+		memcpy(rec, r, sizeof(struct replay_record));
+		rr->pos+=sizeof(struct replay_record);
+		rr->line++;
+		return 1;
+	}
+
+	while(rr->pos<rr->fsize){
+		uint64_t len = rr->fsize-rr->pos;
+		if(len>REPLAY_LINE_MAX){
+			len=REPLAY_LINE_MAX;
+		}
+		const char *s = replay_map(rr, rr->pos, len);
+		const char *nl = memchr(s, '\n', len);
+		rr->line++;
+
+		if(nl==NULL){
+			if(len==REPLAY_LINE_MAX){
+				parse_error(rr, "line is too long");
+			}
+			//last line without a newline
+			nl=s+len;
+		}
+		rr->pos+=(nl-s)+1;
+
+		if(parse_line(rr, s, nl, rec)){
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+struct replay_reader* replay_open(const char *fname, int proc, int nprocs){
+
+	struct replay_reader *rr = malloc(sizeof(struct replay_reader));
+	bzero(rr, sizeof(struct replay_reader));
+	strncpy(rr->fname, fname, PATH_SIZE-1);
+	rr->proc=proc;
+	rr->nprocs=nprocs;
+
+	rr->fd = open(fname, O_RDONLY);
+	if(rr->fd==-1){
+		perror("Error opening replay trace");
+		exit(EXIT_FAILURE);
+	}
+
+	struct stat st;
+	if(fstat(rr->fd, &st)!=0){
+		perror("Error reading replay trace");
+		exit(EXIT_FAILURE);
+	}
+	rr->fsize=st.st_size;
+
+	struct replay_header *hdr = (struct replay_header *) replay_map(rr, 0, sizeof(struct replay_header));
+	if(hdr && memcmp(hdr->magic, REPLAY_MAGIC, sizeof(hdr->magic))==0){
+		if(hdr->version!=REPLAY_VERSION || hdr->record_size!=sizeof(struct replay_record)){
+			printf("%s was written by an incompatible version of DEDIStrace\n", fname);
+			exit(0);
+		}
+		rr->binary=1;
+		rr->pos=sizeof(struct replay_header);
+	}
+
+	return rr;
+}
+
+int replay_next(struct replay_reader *rr, struct user_confs *conf, struct replay_op *op){
+
+	struct replay_record rec;
+	uint64_t total_blocks = region_blocks(conf);
+
+	while(1){
+
+		if(rr->split_blocks==0){
+			if(!replay_read(rr, &rec)){
+				return 0;
+			}
+			//inter-arrival times are relative to the first request of the whole trace
+			if(!rr->started){
+				rr->first_ts=rec.ts_ns;
+				rr->started=1;
+			}
+			if(rec.size==0 || (rec.op!=READ && rec.op!=WRITE)){
+				continue;
+			}
+			rr->split_block=rec.offset/conf->block_size;
+			rr->split_blocks=(rec.offset%conf->block_size+rec.size+conf->block_size-1)/conf->block_size;
+			rr->split_op=rec.op;
+			rr->split_ts=rec.ts_ns;
+		}
+
+		//the part of the request in the current stripe, all with the time of the request
+		uint64_t block = rr->split_block;
+		uint64_t stripe = block/REPLAY_STRIPE_BLOCKS;
+		uint64_t nblocks = REPLAY_STRIPE_BLOCKS-block%REPLAY_STRIPE_BLOCKS;
+		if(nblocks>rr->split_blocks){
+			nblocks=rr->split_blocks;
+		}
+		rr->split_block+=nblocks;
+		rr->split_blocks-=nblocks;
+
+		if(stripe%rr->nprocs!=rr->proc){
+			continue;
+		}
+
+		//the stripes of the process are packed in its file (or device region)
+		uint64_t local = (stripe/rr->nprocs)*REPLAY_STRIPE_BLOCKS+block%REPLAY_STRIPE_BLOCKS;
+		if(nblocks>total_blocks){
+			nblocks=total_blocks;
+		}
+		local=local%total_blocks;
+		if(local+nblocks>total_blocks){
+			local=total_blocks-nblocks;
+		}
+
+		op->offset=(region_first(conf, rr->proc)+local)*conf->block_size;
+		op->size=nblocks*conf->block_size;
+		op->op=rr->split_op;
+
+		//requests that go back in time are issued right away
+		uint64_t elapsed = (rr->split_ts>rr->first_ts) ? rr->split_ts-rr->first_ts : 0;
+		op->due_ns = (conf->replay_speed>0) ? elapsed/conf->replay_speed : 0;
+
+		return 1;
+	}
+}
+
+void replay_close(struct replay_reader *rr){
+
+	if(rr->window){
+		munmap(rr->window, rr->window_len);
+	}
+	close(rr->fd);
+	free(rr);
+}
+
+int check_replay(struct user_confs *conf){
+
+	if(conf->replay==0){
+		return 0;
+	}
+
+	if(conf->mixedIO==1){
+		printf("the operations of a replayed trace cannot be mixed with -m\n");
+		return -1;
+	}
+	if(conf->replay_speed<0){
+		printf("replay speed must be 0 (no delays) or higher\n");
+		return -1;
+	}
+
+	//a full pass reports malformed lines before the processes are launched
+	struct replay_reader *rr = replay_open(conf->replayfile, 0, 1);
+	struct replay_record rec;
+	uint64_t reads=0, writes=0, first=0, last=0;
+
+	while(replay_read(rr, &rec)){
+		if(reads+writes==0){
+			first=rec.ts_ns;
+		}
+		last=rec.ts_ns;
+		if(rec.op==READ){
+			reads++;
+		}else{
+			writes++;
+		}
+	}
+
+	printf("Replaying trace %s (%s): %llu reads %llu writes over %.3f seconds at %.2fx speed\n", conf->replayfile,
+		(rr->binary) ? "binary" : "text", (unsigned long long int) reads, (unsigned long long int) writes,
+		(last>first) ? (last-first)/1.0e9 : 0, conf->replay_speed);
+	if(conf->replay_speed==0){
+		printf("Replay speed is 0, requests are issued without delays\n");
+	}
+
+	replay_close(rr);
+
+	if(reads+writes==0){
+		printf("%s has no read or write requests\n", conf->replayfile);
+		return -1;
+	}
+
+	return 0;
+}
+
+int64_t compile_replay(const char *fname, const char *outname){
+
+	struct replay_reader *rr = replay_open(fname, 0, 1);
+	struct replay_record rec;
+	struct replay_header hdr;
+
+	if(rr->binary){
+		printf("%s is already a binary trace\n", fname);
+		replay_close(rr);
+		return -1;
+	}
+
+	FILE *out = fopen(outname, "w");
+	if(!out){
+		perror("Error opening binary trace");
+		replay_close(rr);
+		return -1;
+	}
+
+	bzero(&hdr, sizeof(struct replay_header));
+	memcpy(hdr.magic, REPLAY_MAGIC, sizeof(hdr.magic));
+	hdr.version=REPLAY_VERSION;
+	hdr.record_size=sizeof(struct replay_record);
+
+	//the header is rewritten with the number of records at the end
+	fwrite(&hdr, sizeof(struct replay_header), 1, out);
+	while(replay_read(rr, &rec)){
+		memset(rec.pad, 0, sizeof(rec.pad));
+		if(fwrite(&rec, sizeof(struct replay_record), 1, out)!=1){
+			perror("Error writing binary trace");
+			fclose(out);
+			replay_close(rr);
+			return -1;
+		}
+		hdr.nrecords++;
+	}
+
+	rewind(out);
+	fwrite(&hdr, sizeof(struct replay_header), 1, out);
+	fclose(out);
+	replay_close(rr);
+
+	return hdr.nrecords;
+}
@@ -0,0 +1,109 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include "../../structs/defines.h"
+
+//Replay of block I/O traces ([replay] section of the configuration file)
+//Text traces have one request per line: <offset bytes>,<size bytes>,<op>,<timestamp seconds>
+//where op starts with R (read) or W (write) as the RWBS field of blkparse, requests with
+//other operations (discards, flushes) are skipped. Fields may also be separated by spaces.
+//Binary traces (DEDIStrace -b) are a replay_header followed by replay_records.
+
+#define REPLAY_MAGIC "DEDISRPL"
+#define REPLAY_VERSION 1
+
+//the trace is read through mmap windows of this size
+#define REPLAY_WINDOW_SIZE (64*1024*1024)
+//longest line of a text trace
+#define REPLAY_LINE_MAX 4096
+
+//requests are split at the stripes of the trace and each stripe is replayed by the same
+//process, so that the order of the operations on each block is kept (and no replayed
+//request has more than REPLAY_STRIPE_BLOCKS blocks)
+#define REPLAY_STRIPE_BLOCKS 256
+
+//first bytes of a binary trace
+struct replay_header{
+	char magic[8];
+	uint32_t version;
+	//size of each replay_record
+	uint32_t record_size;
+	uint64_t nrecords;
+	uint64_t reserved[2];
+};
+
+struct replay_record{
+	//time of the request since the beginning of the trace (ns)
+	uint64_t ts_ns;
+	uint64_t offset;
+	uint32_t size;
+	//READ or WRITE
+	uint8_t op;
+	uint8_t pad[3];
+};
+
+//request of the trace mapped to the file (or device region) of a process
+struct replay_op{
+	//offset and size in bytes, aligned to the block size
+	uint64_t offset;
+	uint64_t size;
+	int op;
+	//time when the request must be issued since the beginning of the replay (ns)
+	uint64_t due_ns;
+};
+
+//streaming reader of a trace for one process
+struct replay_reader{
+	char fname[PATH_SIZE];
+	int fd;
+	uint64_t fsize;
+	int binary;
+
+	//current mmap window
+	char *window;
+	uint64_t window_off;
+	uint64_t window_len;
+
+	//file position of the next line or record and number of the line
+	uint64_t pos;
+	uint64_t line;
+
+	//the reader returns the requests dispatched to process proc of nprocs
+	int proc;
+	int nprocs;
+
+	//timestamp of the first request of the trace (ns)
+	uint64_t first_ts;
+	int started;
+
+	//request of the trace being split at the stripes: next block, blocks left,
+	//operation and timestamp
+	uint64_t split_block;
+	uint64_t split_blocks;
+	int split_op;
+	uint64_t split_ts;
+};
+
+//check the [replay] options and the trace format before forking the processes
+//returns -1 if the trace cannot be replayed
+int check_replay(struct user_confs *conf);
+
+//open the trace for process proc, exits if the trace cannot be read
+struct replay_reader* replay_open(const char *fname, int proc, int nprocs);
+
+//next request (or part of a request) of the process mapped to its file (or device region)
+//and time scaled by the replay speed, returns 0 at the end of the trace
+int replay_next(struct replay_reader *rr, struct user_confs *conf, struct replay_op *op);
+
+void replay_close(struct replay_reader *rr);
+
+//convert a text trace into the binary format, returns the number of records or -1
+int64_t compile_replay(const char *fname, const char *outname);
+
+#endif
@@ -8,24 +8,18 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
 #include "sharedmem.h"
+#include "../../populate/populate.h"
+#include "../tracker/tracker.h"
 #include <sys/mman.h>
 
 
-int loadmem(struct duplicates_info *info){
-
-      info->sum=malloc(sizeof(uint64_t)*info->duplicated_blocks);
-      info->stats=malloc(sizeof(uint64_t)*info->duplicated_blocks);
-      return 1;
-
-}
-
 int loadmmap(uint64_t **mem,uint64_t *sharedmem_size,int *fd_shared, struct duplicates_info *info, struct user_confs *conf){
 
    //Name of shared memory file
-   int result, i;
+   int result;
    int nr_procs = conf->nprocs;
-   struct block_info *content_map;
 
    if(conf->mixedIO==1){
      nr_procs=nr_procs/2;
@@ -35,10 +29,24 @@ int loadmmap(uint64_t **mem,uint64_t *sharedmem_size,int *fd_shared, struct dupl
      nr_procs=1;
    }
 
+   //the content written is regenerated by the final check
+   if(replay_integrity(conf)){
+     nr_procs=0;
+   }
+
+    //the counter of each duplicated content is only needed to output the distribution
+    //and for faults, the distribution itself is kept in private memory as classes
+    uint64_t nstatistics = (conf->distout==1 || conf->fault_measure>0) ? info->duplicated_blocks : 0;
+
+    //the tracker starts in its own cache line, the counters are written by every process
+    uint64_t ncounters = ((nstatistics+1+SHAREDMEM_LINE-1)/SHAREDMEM_LINE)*SHAREDMEM_LINE;
+
     //size of shared memory structure
-    *sharedmem_size = (sizeof(uint64_t)*(info->duplicated_blocks*3+1)) + (sizeof(struct block_info)*(conf->totblocks*nr_procs));
+    *sharedmem_size = (sizeof(uint64_t)*ncounters) + tracker_size(conf, nr_procs);
 
-    *fd_shared = open("dedisbench_0010sharedmemstats", O_RDWR | O_CREAT, (mode_t)0600);
+    //the file is truncated, the counters and trackers of a previous run that did not
+    //end must not be read as content of this one
+    *fd_shared = open("dedisbench_0010sharedmemstats", O_RDWR | O_CREAT | O_TRUNC, (mode_t)0600);
     if (*fd_shared == -1) {
       perror("Error opening file for writing");
       exit(EXIT_FAILURE);
@@ -81,22 +89,18 @@ int loadmmap(uint64_t **mem,uint64_t *sharedmem_size,int *fd_shared, struct dupl
 
     uint64_t* mem_aux=*mem;
     // Now assign the memory region to each variable
-    info->statistics = mem_aux;
-    mem_aux=mem_aux+info->duplicated_blocks;
-    info->sum=mem_aux;
-    mem_aux=mem_aux+info->duplicated_blocks;
-    info->stats=mem_aux;
-    mem_aux=mem_aux+info->duplicated_blocks;
+    info->statistics = NULL;
+    if(nstatistics>0){
+      info->statistics = mem_aux;
+      bzero(info->statistics, sizeof(uint64_t)*nstatistics);
+    }
+    mem_aux=mem_aux+nstatistics;
     info->zerodups = mem_aux;
     mem_aux=mem_aux+1;
-    content_map=(struct block_info *)mem_aux;
   
     *info->zerodups=0;
 
-    info->content_tracker=malloc(sizeof(struct block_info *)*nr_procs);
-    for (i=0; i<nr_procs; i++){
-      info->content_tracker[i]=content_map+(i*conf->totblocks);
-    }
+    init_tracker(conf, info, *mem+ncounters, nr_procs);
 
     return 0;
 }
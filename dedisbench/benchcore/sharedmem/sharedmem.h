@@ -10,7 +10,8 @@
 #include "../duplicates/duplicatedist.h"
 #include "../../structs/defines.h"
 
-int loadmem(struct duplicates_info *info);
+//counters in a cache line
+#define SHAREDMEM_LINE 8
 
 int loadmmap(uint64_t **mem,uint64_t *sharedmem_size,int *fd_shared, struct duplicates_info *info, struct user_confs *conf);
 
@@ -0,0 +1,234 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "tracker.h"
+#include "../content/content.h"
+
+
+int check_tracker(struct user_confs *conf){
+
+  if(conf->tracker!=TRACKER_FULL && conf->tracker!=TRACKER_COMPACT){
+    printf("integrity_tracker must be 0 (full) or 1 (compact)\n");
+    return -1;
+  }
+  //faults keep pointers to the entries of the full tracker
+  if(conf->tracker==TRACKER_COMPACT && conf->usingfaults){
+    printf("the compact integrity tracker cannot be used with fault injection\n");
+    return -1;
+  }
+
+  return 0;
+}
+
+static uint64_t entry_size(struct user_confs *conf){
+  return (conf->tracker==TRACKER_COMPACT) ? sizeof(uint64_t) : sizeof(struct block_info);
+}
+
+uint64_t tracker_size(struct user_confs *conf, int nfiles){
+
+  if(strlen(conf->trackerfile)>0){
+    return 0;
+  }
+  return entry_size(conf)*conf->totblocks*nfiles;
+}
+
+//the tracker is mapped from a sparse file, only the pages of blocks written use memory,
+//the file is removed right away so that it is never left behind
+static void* map_tracker_file(struct user_confs *conf, uint64_t size){
+
+  size=((size+TRACKER_HUGEPAGE-1)/TRACKER_HUGEPAGE)*TRACKER_HUGEPAGE;
+
+  int fd = open(conf->trackerfile, O_RDWR | O_CREAT | O_TRUNC, (mode_t)0600);
+  if(fd==-1){
+    perror("Error opening integrity tracker file");
+    exit(EXIT_FAILURE);
+  }
+  if(ftruncate(fd, size)!=0){
+    perror("Error stretching integrity tracker file");
+    exit(EXIT_FAILURE);
+  }
+
+  void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(mem==MAP_FAILED){
+    perror("Error mmapping integrity tracker file");
+    exit(EXIT_FAILURE);
+  }
+  //best effort, depends on the file system of the file and on the kernel configuration
+  madvise(mem, size, MADV_HUGEPAGE);
+
+  close(fd);
+  unlink(conf->trackerfile);
+
+  return mem;
+}
+
+void init_tracker(struct user_confs *conf, struct duplicates_info *info, void *mem, int nfiles){
+
+  int i;
+
+  info->content_tracker=NULL;
+  info->content_refs=NULL;
+  if(nfiles==0){
+    return;
+  }
+
+  if(strlen(conf->trackerfile)>0){
+    mem = map_tracker_file(conf, entry_size(conf)*conf->totblocks*nfiles);
+  }
+
+  if(conf->tracker==TRACKER_COMPACT){
+    info->content_refs=malloc(sizeof(uint64_t *)*nfiles);
+    for(i=0;i<nfiles;i++){
+      info->content_refs[i]=(uint64_t *)mem+(i*conf->totblocks);
+    }
+  }else{
+    info->content_tracker=malloc(sizeof(struct block_info *)*nfiles);
+    for(i=0;i<nfiles;i++){
+      info->content_tracker[i]=(struct block_info *)mem+(i*conf->totblocks);
+    }
+  }
+}
+
+void* tracker_entries(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t *size){
+
+  *size=entry_size(conf)*conf->totblocks;
+  if(info->content_tracker){
+    return info->content_tracker[pos];
+  }
+  if(info->content_refs){
+    return info->content_refs[pos];
+  }
+  *size=0;
+  return NULL;
+}
+
+//fingerprint of a block, never 0 (blocks not written)
+static uint64_t fingerprint(uint64_t cont_id, int procid, uint64_t ts){
+
+  uint64_t key = content_key(cont_id, procid, ts);
+  return (key==0) ? 1 : key;
+}
+
+void track_block(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk, struct block_info *bi){
+
+  if(info->content_tracker){
+    info->content_tracker[pos][blk].cont_id=bi->cont_id;
+    info->content_tracker[pos][blk].procid=bi->procid;
+    info->content_tracker[pos][blk].ts=bi->ts;
+  }
+  else if(info->content_refs){
+    info->content_refs[pos][blk] = (conf->deterministic==1) ? bi->cont_id+1 : fingerprint(bi->cont_id, bi->procid, bi->ts);
+  }
+}
+
+int tracked_block(struct duplicates_info *info, int pos, uint64_t blk){
+
+  if(info->content_tracker){
+    struct block_info *bf = &info->content_tracker[pos][blk];
+    return bf->ts && bf->cont_id;
+  }
+  if(info->content_refs){
+    return info->content_refs[pos][blk]!=0;
+  }
+  return 0;
+}
+
+//block regenerated from the content id of a deterministic run (see get_writecontent)
+static void ref_block_info(struct user_confs *conf, struct duplicates_info *info, uint64_t ref, struct block_info *bi){
+
+  bi->cont_id=ref-1;
+  if(bi->cont_id<info->duplicated_blocks){
+    bi->procid=-1;
+    bi->ts=-1;
+  }else{
+    bi->procid=unique_procid(info, conf, bi->cont_id);
+    bi->ts=conf->seed+1;
+  }
+}
+
+uint64_t tracked_content_id(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk){
+
+  if(info->content_tracker){
+    return info->content_tracker[pos][blk].cont_id;
+  }
+  if(info->content_refs && conf->deterministic==1 && info->content_refs[pos][blk]!=0){
+    return info->content_refs[pos][blk]-1;
+  }
+  return UINT64_MAX;
+}
+
+int check_tracked_header(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk, char *buf){
+
+  struct block_header hdr;
+  struct block_info bf;
+  memcpy(&hdr, buf, sizeof(struct block_header));
+
+  if(info->content_tracker){
+    bf=info->content_tracker[pos][blk];
+    //same blocks as compare_blocks
+    if(bf.cont_id==0 && bf.ts==0){
+      return -1;
+    }
+  }else{
+    uint64_t ref = info->content_refs[pos][blk];
+    if(ref==0){
+      return -1;
+    }
+    if(conf->deterministic!=1){
+      return hdr.magic!=CONTENT_MAGIC || fingerprint(hdr.cont_id, hdr.procid, hdr.ts)!=ref;
+    }
+    ref_block_info(conf, info, ref, &bf);
+  }
+
+  return hdr.magic!=CONTENT_MAGIC || hdr.cont_id!=bf.cont_id || hdr.procid!=bf.procid || hdr.ts!=bf.ts;
+}
+
+int check_tracked_block(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk, char *buf, FILE *fpi, int final_check){
+
+  struct block_info bf;
+
+  if(info->content_tracker){
+    return compare_blocks(buf, info->content_tracker[pos][blk], conf->block_size, fpi, final_check);
+  }
+
+  uint64_t ref = info->content_refs[pos][blk];
+  if(ref==0){
+    return 0;
+  }
+
+  if(conf->deterministic==1){
+    ref_block_info(conf, info, ref, &bf);
+    return compare_blocks(buf, bf, conf->block_size, fpi, final_check);
+  }
+
+  //the block must be well built and be the one whose fingerprint was tracked
+  struct block_header hdr;
+  memcpy(&hdr, buf, sizeof(struct block_header));
+  if(check_block_content(buf, conf->block_size)!=0){
+    fprintf(fpi, "Error checking integrity for block %llu, its content is corrupted\n", (long long unsigned int) blk);
+    return 1;
+  }
+  if(fingerprint(hdr.cont_id, hdr.procid, hdr.ts)!=ref){
+    if(final_check==0){
+      fprintf(fpi,"There was a mismatch regarding the last content written for block %llu and the content read (id %llu).\n",
+        (long long unsigned int) blk, (long long unsigned int) hdr.cont_id);
+      fprintf(fpi,"Such is possible if the workload being ran is a mixed IO workload\n");
+      fprintf(fpi,"Nevertheless the content of the block seems well built\n");
+    }else{
+      fprintf(fpi, "Error checking integrity for block %llu, content id %llu is not the last one written\n",
+        (long long unsigned int) blk, (long long unsigned int) hdr.cont_id);
+    }
+    return 1;
+  }
+
+  return 0;
+}
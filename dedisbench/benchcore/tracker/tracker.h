@@ -0,0 +1,56 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "../duplicates/duplicatedist.h"
+#include "../../structs/defines.h"
+
+//Content written to each block of each file (or of the device), used by the integrity checks
+//The full tracker keeps a struct block_info per block (info->content_tracker), the compact
+//one 64 bits per block (info->content_refs):
+// - deterministic content: content id + 1, the block is regenerated from it and the seed
+// - otherwise: fingerprint of the identity of the block (content_key of its header)
+//Entries of blocks never written are 0 in both trackers
+#define TRACKER_FULL 0
+#define TRACKER_COMPACT 1
+
+//the tracker file is grown in steps of huge pages
+#define TRACKER_HUGEPAGE (2*1024*1024)
+
+//check the tracker options, returns -1 if they cannot be used
+int check_tracker(struct user_confs *conf);
+
+//bytes of the tracker of nfiles files
+uint64_t tracker_size(struct user_confs *conf, int nfiles);
+
+//assign the tracker of each file, mem has tracker_size bytes (zeroed) unless the
+//tracker is mapped from its own sparse file (tracker_file option)
+void init_tracker(struct user_confs *conf, struct duplicates_info *info, void *mem, int nfiles);
+
+//entries of the tracker of file pos and their size in bytes, NULL without tracker
+void* tracker_entries(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t *size);
+
+//record the content written to block blk of file pos, no-op without tracker
+void track_block(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk, struct block_info *bi);
+
+//1 if the block was written and is tracked
+int tracked_block(struct duplicates_info *info, int pos, uint64_t blk);
+
+//content id last written to the block, UINT64_MAX if it is unknown
+uint64_t tracked_content_id(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk);
+
+//compare only the header of the block read in buf with the one tracked for it, returns 0 if
+//they match, 1 if they do not and -1 if the block is not tracked
+int check_tracked_header(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk, char *buf);
+
+//compare the block read in buf with the content tracked for it, returns 1 if they
+//do not match (reported to fpi as compare_blocks)
+int check_tracked_block(struct user_confs *conf, struct duplicates_info *info, int pos, uint64_t blk, char *buf, FILE *fpi, int final_check);
+
+#endif
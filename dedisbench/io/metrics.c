@@ -0,0 +1,353 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <ctype.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "metrics.h"
+#include "../utils/timing/timing.h"
+
+//size of the text served to clients
+#define METRICS_TEXT_SIZE 65536
+//clients are served by the sampling thread, they cannot hold it for longer than this (ms)
+#define METRICS_CLIENT_TIMEOUT 100
+
+static const double percentiles[] = {50, 90, 99, 99.9};
+static const char *percentile_names[] = {"p50", "p90", "p99", "p999"};
+#define NPERCENTILES 4
+
+
+struct metrics_page* metrics_create(int nprocs){
+
+	int fd = open(METRICS_FILE, O_RDWR | O_CREAT | O_TRUNC, (mode_t)0600);
+	if(fd==-1){
+		perror("Error opening metrics file");
+		exit(EXIT_FAILURE);
+	}
+	if(ftruncate(fd, sizeof(struct metrics_page)*nprocs)!=0){
+		perror("Error stretching metrics file");
+		exit(EXIT_FAILURE);
+	}
+
+	struct metrics_page *pages = mmap(NULL, sizeof(struct metrics_page)*nprocs, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(pages==MAP_FAILED){
+		perror("Error mmapping metrics file");
+		exit(EXIT_FAILURE);
+	}
+	//the mapping is kept after closing the file
+	close(fd);
+
+	return pages;
+}
+
+void metrics_destroy(struct metrics_page *pages, int nprocs){
+	munmap(pages, sizeof(struct metrics_page)*nprocs);
+	unlink(METRICS_FILE);
+}
+
+void metrics_start(struct metrics_page *page, int procid, int iotype){
+	page->pid=getpid();
+	page->procid=procid;
+	page->iotype=iotype;
+	__atomic_store_n(&page->running, 1, __ATOMIC_RELEASE);
+}
+
+void metrics_end(struct metrics_page *page){
+	__atomic_store_n(&page->running, 0, __ATOMIC_RELEASE);
+}
+
+
+//upper bound (ns) of a histogram bucket
+static uint64_t bucket_limit(int b){
+	if(b<METRICS_HIST_SUB){
+		return b+1;
+	}
+	int msb = b/METRICS_HIST_SUB+2;
+	uint64_t sub = b%METRICS_HIST_SUB;
+	return (METRICS_HIST_SUB+sub+1)<<(msb-3);
+}
+
+//totals of all processes
+struct metrics_sample{
+	uint64_t time;
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t bytes;
+	uint64_t lat;
+	uint64_t faults;
+	uint64_t integrity_errors;
+	uint64_t misses_read;
+	int running;
+	uint64_t hist[METRICS_HIST_BUCKETS];
+};
+
+static void metrics_sample(struct metrics_server *server, struct metrics_sample *s){
+
+	int i, b;
+	bzero(s, sizeof(struct metrics_sample));
+	s->time=now_ns();
+
+	for(i=0;i<server->nprocs;i++){
+		struct metrics_page *p = &server->pages[i];
+		s->reads+=__atomic_load_n(&p->reads, __ATOMIC_RELAXED);
+		s->writes+=__atomic_load_n(&p->writes, __ATOMIC_RELAXED);
+		s->bytes+=__atomic_load_n(&p->bytes, __ATOMIC_RELAXED);
+		s->lat+=__atomic_load_n(&p->lat, __ATOMIC_RELAXED);
+		s->faults+=__atomic_load_n(&p->faults, __ATOMIC_RELAXED);
+		s->integrity_errors+=__atomic_load_n(&p->integrity_errors, __ATOMIC_RELAXED);
+		s->misses_read+=__atomic_load_n(&p->misses_read, __ATOMIC_RELAXED);
+		s->running+=__atomic_load_n(&p->running, __ATOMIC_ACQUIRE);
+		for(b=0;b<METRICS_HIST_BUCKETS;b++){
+			s->hist[b]+=__atomic_load_n(&p->hist[b], __ATOMIC_RELAXED);
+		}
+	}
+}
+
+//render the metrics of the last period [prev, cur] in a prometheus like text format
+static int metrics_render(struct metrics_server *server, struct metrics_sample *prev, struct metrics_sample *cur, uint64_t begin, char *text){
+
+	int len=0, i, b;
+	double period=(cur->time-prev->time)/1.0e9;
+	uint64_t ops=(cur->reads+cur->writes)-(prev->reads+prev->writes);
+
+	#define EMIT(...) len+=snprintf(text+len, METRICS_TEXT_SIZE-len, __VA_ARGS__)
+
+	EMIT("dedisbench_uptime_seconds %.3f\n", (cur->time-begin)/1.0e9);
+	EMIT("dedisbench_processes_running %d\n", cur->running);
+	EMIT("dedisbench_iops %.3f\n", ops/period);
+	EMIT("dedisbench_read_iops %.3f\n", (cur->reads-prev->reads)/period);
+	EMIT("dedisbench_write_iops %.3f\n", (cur->writes-prev->writes)/period);
+	EMIT("dedisbench_bandwidth_bytes_per_second %.3f\n", (cur->bytes-prev->bytes)/period);
+	EMIT("dedisbench_latency_avg_ms %.6f\n", ops ? ((cur->lat-prev->lat)/(double)ops)/1.0e6 : 0);
+
+	//percentiles of the operations done in the last period
+	for(i=0;i<NPERCENTILES;i++){
+		uint64_t target=(uint64_t)(ops*percentiles[i]/100.0);
+		uint64_t acc=0;
+		uint64_t limit=0;
+		for(b=0;b<METRICS_HIST_BUCKETS && ops>0;b++){
+			acc+=cur->hist[b]-prev->hist[b];
+			if(acc>target || (acc==ops && acc>0)){
+				limit=bucket_limit(b);
+				break;
+			}
+		}
+		EMIT("dedisbench_latency_%s_ms %.6f\n", percentile_names[i], limit/1.0e6);
+	}
+
+	EMIT("dedisbench_operations_total %llu\n", (unsigned long long int) cur->reads+cur->writes);
+	EMIT("dedisbench_bytes_total %llu\n", (unsigned long long int) cur->bytes);
+	EMIT("dedisbench_faults_injected_total %llu\n", (unsigned long long int) cur->faults);
+	EMIT("dedisbench_integrity_errors_total %llu\n", (unsigned long long int) cur->integrity_errors);
+	EMIT("dedisbench_read_misses_total %llu\n", (unsigned long long int) cur->misses_read);
+
+	for(i=0;i<server->nprocs && len<METRICS_TEXT_SIZE-256;i++){
+		struct metrics_page *p = &server->pages[i];
+		EMIT("dedisbench_process_operations_total{proc=\"%d\",pid=\"%llu\",io=\"%s\"} %llu\n", i, (unsigned long long int) p->pid,
+			(p->iotype==WRITE) ? "write" : "read", (unsigned long long int) (p->reads+p->writes));
+	}
+
+	#undef EMIT
+
+	return len;
+}
+
+static void metrics_reply(struct metrics_server *server, int fd){
+
+	char header[128];
+	struct timeval tv = {.tv_sec = 0, .tv_usec = METRICS_CLIENT_TIMEOUT*1000};
+
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	if(server->http){
+		//the request is not parsed, every request gets the metrics
+		char req[1024];
+		if(read(fd, req, sizeof(req))<0){
+			return;
+		}
+	}
+
+	pthread_mutex_lock(&server->lock);
+	int len=strlen(server->text);
+	if(server->http){
+		int hlen=snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %d\r\n\r\n", len);
+		//clients that disconnect must not raise SIGPIPE in the benchmark
+		if(send(fd, header, hlen, MSG_NOSIGNAL)<0){
+			perror("Error replying to metrics client");
+		}
+	}
+	if(send(fd, server->text, len, MSG_NOSIGNAL)<0){
+		perror("Error replying to metrics client");
+	}
+	pthread_mutex_unlock(&server->lock);
+}
+
+static void* metrics_loop(void *arg){
+
+	struct metrics_server *server = (struct metrics_server *) arg;
+	struct metrics_sample *prev = malloc(sizeof(struct metrics_sample));
+	struct metrics_sample *cur = malloc(sizeof(struct metrics_sample));
+	struct metrics_sample *aux;
+	char *text = malloc(METRICS_TEXT_SIZE);
+
+	metrics_sample(server, prev);
+	uint64_t begin=prev->time;
+	uint64_t next=begin+METRICS_PERIOD;
+
+	while(!__atomic_load_n(&server->stop, __ATOMIC_ACQUIRE)){
+
+		uint64_t now=now_ns();
+		if(now>=next){
+			metrics_sample(server, cur);
+			metrics_render(server, prev, cur, begin, text);
+
+			pthread_mutex_lock(&server->lock);
+			strcpy(server->text, text);
+			pthread_mutex_unlock(&server->lock);
+
+			aux=prev;
+			prev=cur;
+			cur=aux;
+			next+=METRICS_PERIOD;
+			continue;
+		}
+
+		struct pollfd pfd = {.fd = server->fd_listen, .events = POLLIN};
+		//wake up at least every 100 ms to check if the benchmark ended
+		int timeout=(next-now)/1000000+1;
+		if(timeout>100){
+			timeout=100;
+		}
+		if(poll(&pfd, 1, timeout)>0){
+			int fd = accept(server->fd_listen, NULL, NULL);
+			if(fd>=0){
+				metrics_reply(server, fd);
+				close(fd);
+			}
+		}
+	}
+
+	free(prev);
+	free(cur);
+	free(text);
+	return NULL;
+}
+
+static int metrics_listen(struct metrics_server *server, char *endpoint){
+
+	int fd;
+	int is_port=1;
+	char *c;
+
+	for(c=endpoint;*c;c++){
+		if(!isdigit((unsigned char) *c)){
+			is_port=0;
+		}
+	}
+
+	if(is_port){
+		struct sockaddr_in addr;
+		int one=1;
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		if(fd<0){
+			return -1;
+		}
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		bzero(&addr, sizeof(addr));
+		addr.sin_family=AF_INET;
+		addr.sin_port=htons(atoi(endpoint));
+		//only reachable from the local machine
+		addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+		if(bind(fd, (struct sockaddr *) &addr, sizeof(addr))<0){
+			close(fd);
+			return -1;
+		}
+		server->http=1;
+		printf("Serving metrics at http://127.0.0.1:%s/\n", endpoint);
+	}else{
+		struct sockaddr_un addr;
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if(fd<0){
+			return -1;
+		}
+		bzero(&addr, sizeof(addr));
+		addr.sun_family=AF_UNIX;
+		strncpy(addr.sun_path, endpoint, sizeof(addr.sun_path)-1);
+		unlink(endpoint);
+		if(bind(fd, (struct sockaddr *) &addr, sizeof(addr))<0){
+			close(fd);
+			return -1;
+		}
+		server->http=0;
+		strcpy(server->path, endpoint);
+		printf("Serving metrics at UNIX socket %s\n", endpoint);
+	}
+
+	if(listen(fd, 16)<0){
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+struct metrics_server* metrics_serve(struct metrics_page *pages, int nprocs, char *endpoint){
+
+	struct metrics_server *server = malloc(sizeof(struct metrics_server));
+	bzero(server, sizeof(struct metrics_server));
+	server->pages=pages;
+	server->nprocs=nprocs;
+	server->text=malloc(METRICS_TEXT_SIZE);
+	server->text[0]='\0';
+	pthread_mutex_init(&server->lock, NULL);
+
+	server->fd_listen=metrics_listen(server, endpoint);
+	if(server->fd_listen<0){
+		perror("Error creating metrics endpoint");
+		free(server->text);
+		free(server);
+		return NULL;
+	}
+
+	if(pthread_create(&server->thread, NULL, metrics_loop, server)!=0){
+		perror("Error launching metrics thread");
+		close(server->fd_listen);
+		free(server->text);
+		free(server);
+		return NULL;
+	}
+
+	return server;
+}
+
+void metrics_stop(struct metrics_server *server){
+
+	if(!server){
+		return;
+	}
+
+	__atomic_store_n(&server->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(server->thread, NULL);
+	close(server->fd_listen);
+	if(!server->http){
+		unlink(server->path);
+	}
+	pthread_mutex_destroy(&server->lock);
+	free(server->text);
+	free(server);
+}
@@ -0,0 +1,90 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "../structs/defines.h"
+
+//file backing the stats pages, can be mmaped by external tools while the benchmark runs
+#define METRICS_FILE "dedisbench_0010metrics"
+
+//the endpoint refreshes its metrics with this period (ns)
+#define METRICS_PERIOD 1000000000ULL
+
+//latency histogram with 8 sub-buckets per power of 2 (<=12.5% error)
+#define METRICS_HIST_SUB 8
+#define METRICS_HIST_BUCKETS 512
+
+//stats page of a single process, only written by that process
+struct metrics_page{
+	uint64_t pid;
+	int32_t procid;
+	int32_t iotype;
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t bytes;
+	//accumulated latency (ns)
+	uint64_t lat;
+	uint64_t faults;
+	uint64_t integrity_errors;
+	uint64_t misses_read;
+	uint64_t running;
+	uint64_t hist[METRICS_HIST_BUCKETS];
+} __attribute__((aligned(4096)));
+
+struct metrics_server{
+	struct metrics_page *pages;
+	int nprocs;
+	int fd_listen;
+	int http;
+	char path[PATH_SIZE];
+	int stop;
+	pthread_t thread;
+	//last snapshot served to clients
+	char *text;
+	pthread_mutex_t lock;
+};
+
+//create the stats pages of nprocs processes, must be called before forking
+struct metrics_page* metrics_create(int nprocs);
+void metrics_destroy(struct metrics_page *pages, int nprocs);
+
+//called by each process when it starts and ends
+void metrics_start(struct metrics_page *page, int procid, int iotype);
+void metrics_end(struct metrics_page *page);
+
+//account an I/O operation, only relaxed stores to the process own page
+static inline int metrics_bucket(uint64_t ns){
+	if(ns<METRICS_HIST_SUB){
+		return ns;
+	}
+	int msb = 63-__builtin_clzll(ns);
+	int sub = (ns>>(msb-3)) & (METRICS_HIST_SUB-1);
+	return (msb-2)*METRICS_HIST_SUB+sub;
+}
+
+#define metrics_inc(field, n) __atomic_store_n(&(field), (field)+(n), __ATOMIC_RELAXED)
+#define metrics_set(field, v) __atomic_store_n(&(field), (v), __ATOMIC_RELAXED)
+
+static inline void metrics_op(struct metrics_page *page, int op, uint64_t bytes, uint64_t lat){
+	if(op==WRITE){
+		metrics_inc(page->writes, 1);
+	}else{
+		metrics_inc(page->reads, 1);
+	}
+	metrics_inc(page->bytes, bytes);
+	metrics_inc(page->lat, lat);
+	metrics_inc(page->hist[metrics_bucket(lat)], 1);
+}
+
+//serve the metrics of all processes at endpoint, a TCP port on localhost (HTTP)
+//if endpoint is a number or otherwise a UNIX socket path (plain text)
+struct metrics_server* metrics_serve(struct metrics_page *pages, int nprocs, char *endpoint);
+void metrics_stop(struct metrics_server *server);
+
+#endif
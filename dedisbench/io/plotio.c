@@ -14,7 +14,7 @@ static int find_bucket(unsigned long long int i){
 }
 
 
-int write_access_data(const uint64_t* accessesarray, struct user_confs* conf, char* id){
+int write_access_data(struct access_counts* ac, struct user_confs* conf, char* id){
 	int ret = 0;
 	char plotfile_dir[256] = "results/accesses/";
 	char cumul_acc_file_dir[256] = "results/accesses/";
@@ -68,10 +68,14 @@ int write_access_data(const uint64_t* accessesarray, struct user_confs* conf, ch
 	  mode = "sequential";
 	else if(conf->accesstype == UNIFORM)
 	  mode = "uniform";
+	else if(conf->accesstype == ZIPF)
+	  mode = "zipfian";
+	else if(conf->accesstype == STREAMS)
+	  mode = "streams";
 	else
 	  mode = "hotspot";
 
-	uint64_t iter;
+	uint64_t iter, page;
 	// [1:5[[5:10[[10:50[[50:100[[100:500[[500:1000[
 	//P ---10¹---  ------10²----  ------10³--------
 	//     B1            B2             B3
@@ -83,37 +87,50 @@ int write_access_data(const uint64_t* accessesarray, struct user_confs* conf, ch
 	unsigned long long int* acs = calloc(acs_len, sizeof(unsigned long long int));
 	int init = 1, final = 10;
 
-	/* agreggation */
-	for(iter=0;iter<conf->totblocks;iter++){
-		if(accessesarray[iter]>0){
-			pos_touched+=1;
-			bytes_processed+=conf->block_size*accessesarray[iter];
-		}
-			
-		fprintf(fpp,"%llu %llu\n",(unsigned long long int) iter, (unsigned long long int) accessesarray[iter]);
-
-		int bucket = find_bucket((unsigned long long int) accessesarray[iter]);
-		int power = powr(10, bucket);
-		int arr_pos;
-		
-		if((unsigned long long int) accessesarray[iter] >= power){
-			bucket++;
-			power *= 10;
+	/* agreggation, pages of counters that were never allocated only have blocks not accessed */
+	for(page=0;page<ac->npages;page++){
+		if(!ac->pages[page]){
+			continue;
 		}
+		uint64_t last = ((page+1)*ACCESS_PAGE_BLOCKS<ac->nblocks) ? (page+1)*ACCESS_PAGE_BLOCKS : ac->nblocks;
 
-		if((unsigned long long int) accessesarray[iter] >= (power/2)){
-			arr_pos = bucket*2;
-		}else{
-			arr_pos = (bucket*2)-1;
+		for(iter=page*ACCESS_PAGE_BLOCKS;iter<last;iter++){
+			uint64_t count=access_count(ac, iter);
+			if(count==0){
+				continue;
+			}
+			pos_touched+=1;
+			bytes_processed+=conf->block_size*count;
+
+			int bucket = find_bucket((unsigned long long int) count);
+			int power = powr(10, bucket);
+			int arr_pos;
+
+			if((unsigned long long int) count >= power){
+				bucket++;
+				power *= 10;
+			}
+
+			if((unsigned long long int) count >= (power/2)){
+				arr_pos = bucket*2;
+			}else{
+				arr_pos = (bucket*2)-1;
+			}
+
+			if(arr_pos >= acs_len)
+			{
+				acs = realloc(acs, sizeof(unsigned long long int)*acs_len*2);
+				memset(acs + (acs_len), 0, sizeof(unsigned long long int)*acs_len);
+				acs_len *= 2;
+			}
+			acs[arr_pos]++;
 		}
+	}
 
-		if(arr_pos >= acs_len)
-		{
-			acs = realloc(acs, sizeof(unsigned long long int)*acs_len*2);
-			memset(acs + (acs_len), 0, sizeof(unsigned long long int)*acs_len);
-			acs_len *= 2;
-		}
-		acs[arr_pos]++;
+	/* heatmap: first block of each bin, accesses and blocks accessed */
+	for(iter=0;iter<ac->nbins;iter++){
+		fprintf(fpp,"%llu %llu %llu\n", (unsigned long long int) (ac->first+iter*ac->bin_blocks),
+			(unsigned long long int) ac->bin_accesses[iter], (unsigned long long int) ac->bin_touched[iter]);
 	}
 
 	/* printing agreggated data */
@@ -148,149 +165,6 @@ int write_access_data(const uint64_t* accessesarray, struct user_confs* conf, ch
 
 
 
-static void write_snaplat_data(struct stats* stat, FILE* f, FILE* fcompat){
-	
-	fprintf(f,"%llu 0 0\n",(unsigned long long int)stat->beginio);
-	for(int index=0;index < stat->iter_snap; index++){
-		if(f)
-			fprintf(f, "%llu %.3f %f\n", (unsigned long long int) stat->snap_time[index], stat->snap_latency[index], stat->snap_ops[index]);
-		if(fcompat)
-			fprintf(fcompat, "%d %.3f %f\n", (index)*30,stat->snap_latency[index],stat->snap_ops[index]);
-	}
-
-}
-
-
-
-static void write_snapthr_data(struct stats* stat, FILE* f, FILE* fcompat){
-	
-	fprintf(f,"%llu 0 0\n",(unsigned long long int)stat->beginio);
-	for(int index=0 ;index < stat->iter_snap; index++){
-		if(f)
-			fprintf(f, "%llu %.3f %f\n", (unsigned long long int) stat->snap_time[index], stat->snap_throughput[index], stat->snap_ops[index]);
-		if(fcompat)
-			fprintf(fcompat, "%d %.3f %f\n", (index)*30,stat->snap_throughput[index],stat->snap_ops[index]);
-	}
-
-}
-
-
-
-int write_latency_throughput_snaps(struct stats* stat, struct user_confs* conf, char* id)
-{
-	  int ret = 0;
-	  
-	  //dir for raw file (unprocessed data) 
-	  char snap_thr_dir_out[256] = "./results/latthr/";
-
-	  //dir for processed data file, to be used by
-	  //the gnuplot
-	  char snap_thr_dir_compat[256] = "./results/latthr/";
-	  
-	  char snapthrname[PATH_SIZE];
-	  char snapthrfmt[PATH_SIZE];
-	  strcpy(snapthrname,conf->printfile);
-	  strcat(snapthrname,"snapthr");
-	  if(conf->iotype==WRITE){
-		  strcat(snapthrname,"write");
-	  }
-	  else{
-		  strcat(snapthrname,"read");
-	  }
-	  
-	  strcat(snapthrname,id);
-	  strcat(snap_thr_dir_out, snapthrname);
-
-	  strcpy(snapthrfmt, snapthrname);
-	  strcat(snapthrfmt, "compat");
-	  strcat(snap_thr_dir_compat, snapthrfmt);
-
-	  // latency 
-	  char snap_lat_dir_out[256] = "./results/latthr/";
-	  char snap_lat_dir_compat[256] = "./results/latthr/";
-	  char snaplatname[PATH_SIZE];
-	  char snaplatfmt[PATH_SIZE];
-	  strcpy(snaplatname,conf->printfile);
-	  strcat(snaplatname,"snaplat");
-	  if(conf->iotype==WRITE){
-	  	  strcat(snaplatname,"write");
-	  }
-	  else{
-	  	  strcat(snaplatname,"read");
-	  }
-	 
-	  strcat(snaplatname,id);
-	  strcat(snap_lat_dir_out, snaplatname);
-	  
-	  strcpy(snaplatfmt, snaplatname);
-	  strcat(snaplatfmt, "compat");
-	  strcat(snap_lat_dir_compat, snaplatfmt);
-	 
-	  // write latency data 
-	  //printf("Opening %s...", snap_lat_dir_out);
-	  FILE* pf=fopen(snap_lat_dir_out,"a");
-	  if(!pf){
-		  ret = 1;
-		  //printf("ERROR\n");
-		  return ret;
-	  }
-	  //printf("DONE\n");
-	  //fprintf(pf,"%llu 0 0\n", (unsigned long long int)stat->beginio);
-	  
-	  //printf("Opening %s...", snap_lat_dir_compat);
-	  FILE* pfcompat = fopen(snap_lat_dir_compat,"w");
-	  if(!pfcompat){
-		  ret = 1;
-		  //printf("ERROR\n");
-		  return ret;
-	  }
-	  //printf("DONE\n");
-	  write_snaplat_data(stat, pf, pfcompat); 
-	  fclose(pf);
-	  fclose(pfcompat);
-	
-	  // write throughput data 
-	  pf=fopen(snap_thr_dir_out,"a"); 
-	  if(!pf){
-		  ret = 1;
-		  return ret;
-	  }
-	  pfcompat = fopen(snap_thr_dir_compat,"w");
-	  if(!pfcompat){
-		  ret = 1;
-		  return ret;
-	  }
-
-	  //fprintf(pf,"%llu 0 0\n",(unsigned long long int)stat->beginio);
-	  
-	  write_snapthr_data(stat, pf,pfcompat); 
-	  fclose(pf);
-	  fclose(pfcompat);
-	 
-	  // dir of plot file
-	  char snap_plot_dir[256] = "results/latthr/";
-	  // plot file name
-	  char plotfile[PATH_SIZE];
-	  strcpy(plotfile,conf->printfile);
-	  strcat(plotfile,id);
-	  strcat(plotfile,"plot");
-	  // completing the directory
-	  strcat(snap_plot_dir, plotfile);
-	  
-	  // write plot file 
-	  pf = fopen(snap_plot_dir, "w");
-	  if(!pf){
-		  ret = 1;
-		  return ret;
-	  }
-	  write_plot_file_latency_throughput(pf,conf->distfile, snaplatfmt, snapthrfmt);
-	  fclose(pf);
-	  
-	  return ret;
-}
-
-
-
 void write_plot_file_distribution(FILE* f, char* distcumulfile, char* distfile)
 {
 	fprintf(f, "set grid ytics lt 0 lw 1 lc rgb \"#bbbbbb\"\n");
@@ -7,6 +7,7 @@
 #define PLOTIO_H
 
 #include "../structs/defines.h"
+#include "../benchcore/accesses/counts.h"
 
 //
 // writes distribution plotfile to be passed to gnuplot
@@ -24,13 +25,8 @@ void write_plot_file_latency_throughput(FILE*, char*, char*,char*);
 void write_plot_file_accesses(FILE*, char*);
 
 //
-// processes latency and throughput data a writes it to file
+// processes and writes accesses data (heatmap and histogram of the accesses per block)
 //
-int write_latency_throughput_snaps(struct stats*, struct user_confs*, char*);
-
-//
-// processes and writes accesses data
-//
-int write_access_data(const uint64_t* accessesarray, struct user_confs* conf, char* id);
+int write_access_data(struct access_counts* ac, struct user_confs* conf, char* id);
 
 #endif
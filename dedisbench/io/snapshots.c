@@ -0,0 +1,209 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "snapshots.h"
+#include "plotio.h"
+#include "../utils/timing/timing.h"
+
+//snapshot times are written as wall clock microseconds
+#define SNAP_TIME_US(t) ((unsigned long long int) ((t)+timing_epoch_offset_ns())/1000)
+
+//the coordinator checks for terminated processes at least this often (us)
+#define COORD_POLL_US 100000
+
+
+//name of a snapshot file: <printfile>snap<kind><write|read><id>
+static void snap_name(char* name, struct user_confs *conf, char* kind, char* id){
+
+	strcpy(name,conf->printfile);
+	strcat(name,kind);
+	if(conf->iotype==WRITE){
+		strcat(name,"write");
+	}
+	else{
+		strcat(name,"read");
+	}
+	strcat(name,id);
+}
+
+static FILE* snap_fopen(char* name, char* mode){
+
+	char path[256] = "./results/latthr/";
+	strcat(path, name);
+	FILE* f = fopen(path, mode);
+	if(!f){
+		printf("Couldnt create latency and throughput file %s\n", path);
+	}
+	return f;
+}
+
+struct snap_series* snap_open(struct user_confs *conf, char* id){
+
+	struct snap_series *series = malloc(sizeof(struct snap_series));
+	char name[PATH_SIZE];
+
+	series->nsnaps=0;
+	series->interval=conf->snap_interval;
+	series->begin_written=0;
+
+	//raw files are appended so that consecutive runs are kept
+	snap_name(name, conf, "snaplat", id);
+	series->lat = snap_fopen(name, "a");
+	strcpy(series->latcompatname, name);
+	strcat(series->latcompatname, "compat");
+	series->latcompat = snap_fopen(series->latcompatname, "w");
+
+	snap_name(name, conf, "snapthr", id);
+	series->thr = snap_fopen(name, "a");
+	strcpy(series->thrcompatname, name);
+	strcat(series->thrcompatname, "compat");
+	series->thrcompat = snap_fopen(series->thrcompatname, "w");
+
+	return series;
+}
+
+void snap_write(struct snap_series *series, struct stats *stat){
+
+	if(stat->snap_totops==0){
+		return;
+	}
+
+	double throughput=(stat->snap_totops/((stat->t1snap-stat->last_snap_time)/1.0e9));
+	double latency=(stat->snap_lat/stat->snap_totops)/1.0e6;
+	//compat files are indexed by the number of seconds since the first snapshot
+	double elapsed=series->nsnaps*(series->interval/1.0e9);
+
+	if(!series->begin_written){
+		if(series->lat)
+			fprintf(series->lat,"%llu 0 0\n",SNAP_TIME_US(stat->beginio));
+		if(series->thr)
+			fprintf(series->thr,"%llu 0 0\n",SNAP_TIME_US(stat->beginio));
+		series->begin_written=1;
+	}
+
+	if(series->lat)
+		fprintf(series->lat, "%llu %.3f %f\n", SNAP_TIME_US(stat->t1snap), latency, (double) stat->snap_totops);
+	if(series->latcompat)
+		fprintf(series->latcompat, "%g %.3f %f\n", elapsed, latency, (double) stat->snap_totops);
+	if(series->thr)
+		fprintf(series->thr, "%llu %.3f %f\n", SNAP_TIME_US(stat->t1snap), throughput, (double) stat->snap_totops);
+	if(series->thrcompat)
+		fprintf(series->thrcompat, "%g %.3f %f\n", elapsed, throughput, (double) stat->snap_totops);
+
+	series->nsnaps++;
+}
+
+void snap_close(struct snap_series *series, struct user_confs *conf, char* id){
+
+	if(series->lat)
+		fclose(series->lat);
+	if(series->latcompat)
+		fclose(series->latcompat);
+	if(series->thr)
+		fclose(series->thr);
+	if(series->thrcompat)
+		fclose(series->thrcompat);
+
+	// plot file name
+	char plotfile[PATH_SIZE];
+	strcpy(plotfile,conf->printfile);
+	strcat(plotfile,id);
+	strcat(plotfile,"plot");
+
+	FILE* pf = snap_fopen(plotfile, "w");
+	if(pf){
+		write_plot_file_latency_throughput(pf,conf->distfile, series->latcompatname, series->thrcompatname);
+		fclose(pf);
+	}
+
+	free(series);
+}
+
+
+struct snap_counters* snap_counters_create(int nprocs){
+
+	struct snap_counters *counters = mmap(NULL, sizeof(struct snap_counters)*nprocs, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(counters==MAP_FAILED){
+		perror("Error mmapping snapshot counters");
+		exit(EXIT_FAILURE);
+	}
+	//anonymous mappings are zero filled
+	return counters;
+}
+
+void snap_counters_destroy(struct snap_counters *counters, int nprocs){
+	munmap(counters, sizeof(struct snap_counters)*nprocs);
+}
+
+void snap_counters_publish(struct snap_counters *c, struct stats *stat){
+	__atomic_store_n(&c->ops, stat->tot_ops, __ATOMIC_RELAXED);
+	__atomic_store_n(&c->lat, (uint64_t) stat->latency, __ATOMIC_RELAXED);
+}
+
+
+void snap_coordinator(struct user_confs *conf, struct snap_counters *counters, int nprocs){
+
+	char name[PATH_SIZE];
+	FILE* f;
+	int i;
+	int nprocstowait=nprocs;
+
+	strcpy(name,conf->printfile);
+	strcat(name,SNAP_CLUSTER_SUFFIX);
+	f = snap_fopen(name, "w");
+	if(f){
+		fprintf(f, "#time(us) throughput(blocks/s) latency(ms) ops\n");
+	}
+
+	uint64_t last_ops=0, last_lat=0;
+	uint64_t last_sample=now_ns();
+	uint64_t next_sample=last_sample+conf->snap_interval;
+	uint64_t poll=(conf->snap_interval/1000<COORD_POLL_US) ? conf->snap_interval/1000 : COORD_POLL_US;
+
+	while(nprocstowait>0){
+
+		int status;
+		pid_t pid;
+		while(nprocstowait>0 && (pid = waitpid(-1, &status, WNOHANG))>0){
+			printf("Terminating process with PID %ld exited with status 0x%x.\n", (long)pid, status);
+			--nprocstowait;
+		}
+
+		uint64_t now=now_ns();
+		if(now>=next_sample || nprocstowait==0){
+
+			uint64_t ops=0, lat=0;
+			for(i=0;i<nprocs;i++){
+				ops+=__atomic_load_n(&counters[i].ops, __ATOMIC_RELAXED);
+				lat+=__atomic_load_n(&counters[i].lat, __ATOMIC_RELAXED);
+			}
+
+			if(f && ops>last_ops){
+				fprintf(f, "%llu %.3f %.3f %llu\n", SNAP_TIME_US(now), (ops-last_ops)/((now-last_sample)/1.0e9),
+					((lat-last_lat)/(double)(ops-last_ops))/1.0e6, (unsigned long long int) ops-last_ops);
+				fflush(f);
+			}
+
+			last_ops=ops;
+			last_lat=lat;
+			last_sample=now;
+			next_sample=now+conf->snap_interval;
+		}
+
+		if(nprocstowait>0){
+			usleep(poll);
+		}
+	}
+
+	if(f){
+		fclose(f);
+	}
+}
@@ -0,0 +1,67 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef SNAPSHOTS_H
+#define SNAPSHOTS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "../structs/defines.h"
+
+//default and minimum interval between snapshots (ns)
+#define SNAP_INTERVAL_DEFAULT 30000000000ULL
+#define SNAP_INTERVAL_MIN 100000000ULL
+
+//cluster wide time series written by the coordinator
+#define SNAP_CLUSTER_SUFFIX "snapcluster"
+
+//snapshot files of a single process, written as the benchmark runs
+struct snap_series{
+	FILE* lat;
+	FILE* latcompat;
+	FILE* thr;
+	FILE* thrcompat;
+	char latcompatname[PATH_SIZE];
+	char thrcompatname[PATH_SIZE];
+	//number of snapshots written
+	uint64_t nsnaps;
+	uint64_t interval;
+	int begin_written;
+};
+
+//counters published by each process to the coordinator
+//each process has its own cache line so processes never share one
+struct snap_counters{
+	//operations and accumulated latency (ns) after ramp up
+	uint64_t ops;
+	uint64_t lat;
+	//set when the process finished
+	uint64_t done;
+	//write requests performed, including ramp up (set when the process finished)
+	uint64_t wreqs;
+} __attribute__((aligned(64)));
+
+
+//open the snapshot files of process id
+struct snap_series* snap_open(struct user_confs *conf, char* id);
+
+//append a snapshot with the operations done since the previous one
+void snap_write(struct snap_series *series, struct stats *stat);
+
+//close the files and write the gnuplot file
+void snap_close(struct snap_series *series, struct user_confs *conf, char* id);
+
+//shared counters for nprocs processes, must be created before forking
+struct snap_counters* snap_counters_create(int nprocs);
+void snap_counters_destroy(struct snap_counters *counters, int nprocs);
+
+//publish the totals of a process (only relaxed stores, no locking)
+void snap_counters_publish(struct snap_counters *c, struct stats *stat);
+
+//samples the counters of all processes every snapshot interval, writing the
+//aggregated time series, until all nprocs children exit
+void snap_coordinator(struct user_confs *conf, struct snap_counters *counters, int nprocs);
+
+#endif
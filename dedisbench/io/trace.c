@@ -0,0 +1,197 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "trace.h"
+#include "../utils/timing/timing.h"
+
+
+//map the window of the trace file that starts at offset off
+static void trace_map_window(struct trace_log *tl, uint64_t off){
+
+	if(tl->window){
+		munmap(tl->window, TRACE_WINDOW_SIZE);
+		tl->window=NULL;
+	}
+
+	//the file must be stretched before the window is touched
+	if(ftruncate(tl->fd, off+TRACE_WINDOW_SIZE)!=0){
+		perror("Error stretching trace file");
+		exit(EXIT_FAILURE);
+	}
+
+	tl->window = mmap(NULL, TRACE_WINDOW_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, tl->fd, off);
+	if(tl->window==MAP_FAILED){
+		perror("Error mmapping trace file");
+		exit(EXIT_FAILURE);
+	}
+	tl->window_off=off;
+}
+
+//append len bytes to the trace file, moving the mmap window when it is full
+static void trace_write_bytes(struct trace_log *tl, const char *src, uint64_t len){
+
+	while(len>0){
+		uint64_t pos = tl->fsize - tl->window_off;
+		if(pos==TRACE_WINDOW_SIZE){
+			trace_map_window(tl, tl->window_off+TRACE_WINDOW_SIZE);
+			pos=0;
+		}
+
+		uint64_t n = TRACE_WINDOW_SIZE-pos;
+		if(n>len){
+			n=len;
+		}
+
+		memcpy(tl->window+pos, src, n);
+		tl->fsize+=n;
+		src+=n;
+		len-=n;
+	}
+}
+
+//drains the ring of a process into its trace file
+static void* trace_writer(void *arg){
+
+	struct trace_log *tl = (struct trace_log *) arg;
+	uint64_t tail = tl->tail;
+
+	while(1){
+		int stop = __atomic_load_n(&tl->stop, __ATOMIC_ACQUIRE);
+		uint64_t head = __atomic_load_n(&tl->head, __ATOMIC_ACQUIRE);
+
+		if(head==tail){
+			//the process only sets stop after publishing its last record
+			if(stop){
+				break;
+			}
+			usleep(1000);
+			continue;
+		}
+
+		while(tail<head){
+			uint64_t idx = tail & (TRACE_RING_SIZE-1);
+			uint64_t n = head-tail;
+			//do not go past the end of the ring, the rest is copied in the next iteration
+			if(n>TRACE_RING_SIZE-idx){
+				n=TRACE_RING_SIZE-idx;
+			}
+
+			trace_write_bytes(tl, (char *) &tl->ring[idx], n*sizeof(struct trace_record));
+			tail+=n;
+			//release the slots to the process
+			__atomic_store_n(&tl->tail, tail, __ATOMIC_RELEASE);
+		}
+	}
+
+	return NULL;
+}
+
+
+struct trace_log* trace_open(int procid, int iotype, struct user_confs *conf){
+
+	struct trace_log *tl;
+	char name[PATH_SIZE];
+
+	sprintf(name, "%s%d", TRACE_FILE, procid);
+
+	if(posix_memalign((void **) &tl, 64, sizeof(struct trace_log))!=0){
+		perror("Error allocating trace log");
+		exit(EXIT_FAILURE);
+	}
+	bzero(tl, sizeof(struct trace_log));
+
+	tl->ring = malloc(sizeof(struct trace_record)*TRACE_RING_SIZE);
+	if(!tl->ring){
+		perror("Error allocating trace ring");
+		exit(EXIT_FAILURE);
+	}
+
+	tl->fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(tl->fd==-1){
+		perror("Error opening trace file");
+		exit(EXIT_FAILURE);
+	}
+
+	memcpy(tl->hdr.magic, TRACE_MAGIC, sizeof(tl->hdr.magic));
+	tl->hdr.version=TRACE_VERSION;
+	tl->hdr.record_size=sizeof(struct trace_record);
+	tl->hdr.procid=procid;
+	tl->hdr.iotype=iotype;
+	tl->hdr.block_size=conf->block_size;
+	tl->hdr.nrecords=0;
+	tl->hdr.epoch_offset_ns=timing_epoch_offset_ns();
+
+	trace_map_window(tl, 0);
+	//header is rewritten with the final number of records at trace_close
+	trace_write_bytes(tl, (char *) &tl->hdr, sizeof(struct trace_header));
+
+	if(pthread_create(&tl->writer, NULL, trace_writer, tl)!=0){
+		perror("Error launching trace writer thread");
+		exit(EXIT_FAILURE);
+	}
+
+	return tl;
+}
+
+
+void trace_op(struct trace_log *tl, uint64_t start_ns, uint64_t latency_ns, uint64_t offset, uint64_t nblocks, int op, uint64_t cont_id, int fault){
+
+	uint64_t head = tl->head;
+
+	//ring is full, wait for the writer thread to catch up
+	while(head-__atomic_load_n(&tl->tail, __ATOMIC_ACQUIRE)>=TRACE_RING_SIZE){
+		tl->stalls++;
+		sched_yield();
+	}
+
+	struct trace_record *rec = &tl->ring[head & (TRACE_RING_SIZE-1)];
+	rec->start_ns=start_ns;
+	rec->latency_ns=latency_ns;
+	rec->offset=offset;
+	rec->nblocks=nblocks;
+	rec->cont_id=cont_id;
+	rec->op=op;
+	rec->fault=fault;
+
+	//publish the record to the writer thread
+	__atomic_store_n(&tl->head, head+1, __ATOMIC_RELEASE);
+}
+
+
+void trace_close(struct trace_log *tl){
+
+	__atomic_store_n(&tl->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(tl->writer, NULL);
+
+	munmap(tl->window, TRACE_WINDOW_SIZE);
+
+	//remove the unused part of the last window
+	if(ftruncate(tl->fd, tl->fsize)!=0){
+		perror("Error truncating trace file");
+	}
+
+	tl->hdr.nrecords=(tl->fsize-sizeof(struct trace_header))/sizeof(struct trace_record);
+	if(pwrite(tl->fd, &tl->hdr, sizeof(struct trace_header), 0)!=sizeof(struct trace_header)){
+		perror("Error writing trace header");
+	}
+	close(tl->fd);
+
+	if(tl->stalls>0){
+		printf("Process %d waited %llu times for the trace writer\n", tl->hdr.procid, (unsigned long long int) tl->stalls);
+	}
+
+	free(tl->ring);
+	free(tl);
+}
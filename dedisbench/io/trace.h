@@ -0,0 +1,102 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "../structs/defines.h"
+
+//binary trace files are written to results/tracep<processid>
+#define TRACE_FILE "results/tracep"
+
+#define TRACE_MAGIC "DEDTRACE"
+#define TRACE_VERSION 2
+
+//number of records buffered by each process (must be a power of 2)
+#define TRACE_RING_SIZE (1<<16)
+//the trace file is written through mmap windows of this size
+#define TRACE_WINDOW_SIZE (64*1024*1024)
+
+//content id used when the content of an operation is unknown (eg: reads without integrity)
+#define TRACE_NO_CONTENT UINT64_MAX
+
+//fault flag of each record
+#define TRACE_FAULT_NONE 0
+#define TRACE_FAULT_INJECTED 1
+
+//first bytes of a trace file
+struct trace_header{
+	char magic[8];
+	uint32_t version;
+	//size of each trace_record, for readers to check compatibility
+	uint32_t record_size;
+	int32_t procid;
+	int32_t iotype;
+	uint64_t block_size;
+	//number of records written to the file (set when the trace is closed)
+	uint64_t nrecords;
+	//add this value to record timestamps to get wall clock nanoseconds
+	uint64_t epoch_offset_ns;
+	uint64_t reserved[2];
+};
+
+//fixed-width record logged for each I/O operation
+struct trace_record{
+	//time when the operation was issued (ns)
+	uint64_t start_ns;
+	//operation latency (ns)
+	uint64_t latency_ns;
+	//offset of the operation in bytes
+	uint64_t offset;
+	//content id written or expected to be read at the first block of the operation
+	uint64_t cont_id;
+	//READ or WRITE
+	uint8_t op;
+	//TRACE_FAULT_NONE or TRACE_FAULT_INJECTED
+	uint8_t fault;
+	uint8_t pad[2];
+	//size of the operation in blocks (of block_size bytes)
+	uint32_t nblocks;
+};
+
+//single producer (the benchmark process) single consumer (writer thread) ring
+//head and tail are kept in distinct cache lines so that they do not bounce
+//between the two threads
+struct trace_log{
+
+	//written by the benchmark process
+	uint64_t head __attribute__((aligned(64)));
+	//number of times the process had to wait for the writer thread
+	uint64_t stalls;
+
+	//written by the writer thread
+	uint64_t tail __attribute__((aligned(64)));
+
+	struct trace_record *ring __attribute__((aligned(64)));
+	int stop;
+	pthread_t writer;
+
+	//trace file and current mmap window
+	int fd;
+	char *window;
+	uint64_t window_off;
+	//bytes already written to the file
+	uint64_t fsize;
+
+	struct trace_header hdr;
+};
+
+//create the trace file for process procid and launch its writer thread
+struct trace_log* trace_open(int procid, int iotype, struct user_confs *conf);
+
+//log a single operation, only blocks if the writer thread is TRACE_RING_SIZE records behind
+void trace_op(struct trace_log *tl, uint64_t start_ns, uint64_t latency_ns, uint64_t offset, uint64_t nblocks, int op, uint64_t cont_id, int fault);
+
+//drain pending records, write the header and close the trace file
+void trace_close(struct trace_log *tl);
+
+#endif
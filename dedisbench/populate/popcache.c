@@ -0,0 +1,324 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include "popcache.h"
+#include "../benchcore/tracker/tracker.h"
+#include "../utils/random/random.h"
+
+#define COPY_CHUNK (4*1024*1024)
+//paths of the cache entries, longer than the cache directory
+#define ENTRY_PATH_SIZE (PATH_SIZE+64)
+
+
+//FNV-1a
+static uint64_t hash64(const void *data, uint64_t len, uint64_t h){
+
+	const unsigned char *p = (const unsigned char *) data;
+	uint64_t i;
+
+	for(i=0;i<len;i++){
+		h^=p[i];
+		h*=0x100000001b3ULL;
+	}
+	return h;
+}
+
+//everything that changes the content written by the population of file idproc,
+//the tracker is checked by the size of its entries
+static void popcache_key(struct user_confs *conf, int idproc, char *key){
+
+	struct stat st;
+	char *dist = realpath(conf->distfile, NULL);
+
+	if(dist==NULL || stat(dist, &st)!=0){
+		bzero(&st, sizeof(struct stat));
+	}
+
+	snprintf(key, POPCACHE_KEY_SIZE, "dist=%s:%llu:%llu seed=%llu nprocs=%d proc=%d raw=%d filesize=%llu bs=%llu "
+		"compress=%d entropy=%d runlength=%s deterministic=%d",
+		(dist) ? dist : conf->distfile, (unsigned long long int) st.st_size, (unsigned long long int) st.st_mtime,
+		(unsigned long long int) conf->seed, conf->nprocs, idproc, conf->rawdevice,
+		(unsigned long long int) conf->filesize, (unsigned long long int) conf->block_size,
+		conf->compressibility, conf->entropy, conf->runlength, conf->deterministic);
+
+	free(dist);
+}
+
+static void popcache_path(struct user_confs *conf, char *key, const char *ext, char *path){
+
+	snprintf(path, ENTRY_PATH_SIZE, "%s/dedisbench_pop_%016llx.%s", conf->popcache,
+		(unsigned long long int) hash64(key, strlen(key), 0xcbf29ce484222325ULL), ext);
+}
+
+//devices written by the benchmark no longer hold the population once it ends
+static int writes_device(struct user_confs *conf){
+
+	return conf->rawdevice==1 && (conf->iotype==WRITE || conf->mixedIO==1 || conf->replay==1);
+}
+
+int check_popcache(struct user_confs *conf){
+
+	struct stat st;
+
+	if(strlen(conf->popcache)==0){
+		return 0;
+	}
+	if(stat(conf->popcache, &st)!=0 || !S_ISDIR(st.st_mode)){
+		printf("population_cache %s must be an existing directory\n", conf->popcache);
+		return -1;
+	}
+	//the duplicate statistics of the population are only collected while populating
+	if(conf->distout==1 || conf->fault_measure>0){
+		printf("population_cache is not used when the duplicates distribution or faults are measured\n");
+		bzero(conf->popcache, PATH_SIZE);
+	}
+
+	return 0;
+}
+
+static int read_all(int fd, void *buf, uint64_t len, uint64_t off){
+
+	uint64_t done=0;
+	while(done<len){
+		ssize_t res = pread(fd, (char *) buf+done, len-done, off+done);
+		if(res<=0){
+			return -1;
+		}
+		done+=res;
+	}
+	return 0;
+}
+
+static int write_all(int fd, const void *buf, uint64_t len, uint64_t off){
+
+	uint64_t done=0;
+	while(done<len){
+		ssize_t res = pwrite(fd, (const char *) buf+done, len-done, off+done);
+		if(res<=0){
+			return -1;
+		}
+		done+=res;
+	}
+	return 0;
+}
+
+//make dst a copy of the first len bytes of src, sharing its extents when the file system allows it
+static int clone_file(int dst, int src, uint64_t len){
+
+	if(ftruncate(dst, 0)!=0){
+		return -1;
+	}
+	if(ioctl(dst, FICLONE, src)==0){
+		return 0;
+	}
+
+	loff_t in=0, out=0;
+	while(out<len){
+		ssize_t res = copy_file_range(src, &in, dst, &out, len-out, 0);
+		if(res<=0){
+			break;
+		}
+	}
+	if(out==len){
+		return 0;
+	}
+
+	//copy_file_range is not supported between these files
+	char *buf;
+	if(posix_memalign((void **) &buf, 4096, COPY_CHUNK)!=0){
+		return -1;
+	}
+	for(;out<len;out+=COPY_CHUNK){
+		uint64_t n = (out+COPY_CHUNK<len) ? COPY_CHUNK : len-out;
+		if(read_all(src, buf, n, out)!=0 || write_all(dst, buf, n, out)!=0){
+			free(buf);
+			return -1;
+		}
+	}
+	free(buf);
+
+	return 0;
+}
+
+//checksums of blocks spread over the device
+static int sample_device(int fd, struct user_confs *conf, char *key, struct popcache_sample *samples){
+
+	uint64_t i, totb=conf->filesize/conf->block_size;
+	uint64_t stride = (totb>POPCACHE_SAMPLES) ? totb/POPCACHE_SAMPLES : 1;
+	struct rng rng;
+	char *buf;
+
+	if(posix_memalign((void **) &buf, 4096, conf->block_size)!=0){
+		return -1;
+	}
+	rng_seed(&rng, hash64(key, strlen(key), 0));
+
+	for(i=0;i<POPCACHE_SAMPLES;i++){
+		samples[i].blk = (i*stride+rng_range(&rng, stride))%totb;
+		if(read_all(fd, buf, conf->block_size, samples[i].blk*conf->block_size)!=0){
+			free(buf);
+			return -1;
+		}
+		samples[i].sum=hash64(buf, conf->block_size, 0xcbf29ce484222325ULL);
+	}
+	free(buf);
+
+	return 0;
+}
+
+int restore_population(int fd, char *name, struct user_confs *conf, struct duplicates_info *info, int idproc){
+
+	char key[POPCACHE_KEY_SIZE], path[ENTRY_PATH_SIZE];
+	struct popcache_header hdr;
+	struct popcache_sample samples[POPCACHE_SAMPLES], cur[POPCACHE_SAMPLES];
+	uint64_t tracker_bytes;
+
+	if(strlen(conf->popcache)==0){
+		return 0;
+	}
+
+	popcache_key(conf, idproc, key);
+	popcache_path(conf, key, "meta", path);
+	void *entries = tracker_entries(conf, info, (conf->rawdevice==1) ? 0 : idproc, &tracker_bytes);
+
+	int mfd = open(path, O_RDONLY);
+	if(mfd==-1){
+		return 0;
+	}
+	if(read_all(mfd, &hdr, sizeof(struct popcache_header), 0)!=0 || memcmp(hdr.magic, POPCACHE_MAGIC, sizeof(hdr.magic))!=0
+		|| hdr.version!=POPCACHE_VERSION || strncmp(hdr.key, key, POPCACHE_KEY_SIZE)!=0 || hdr.tracker_bytes!=tracker_bytes
+		|| hdr.nsamples>POPCACHE_SAMPLES){
+		close(mfd);
+		return 0;
+	}
+	uint64_t off = sizeof(struct popcache_header);
+
+	if(conf->rawdevice==1){
+		if(hdr.nsamples!=POPCACHE_SAMPLES || read_all(mfd, samples, sizeof(samples), off)!=0
+			|| sample_device(fd, conf, key, cur)!=0 || memcmp(samples, cur, sizeof(samples))!=0){
+			printf("%s does not hold the cached population anymore\n", name);
+			close(mfd);
+			return 0;
+		}
+		off+=sizeof(samples);
+	}else{
+		char img[ENTRY_PATH_SIZE];
+		struct stat st;
+		popcache_path(conf, key, "img", img);
+
+		int ifd = open(img, O_RDONLY);
+		if(ifd==-1){
+			close(mfd);
+			return 0;
+		}
+		if(fstat(ifd, &st)!=0 || (uint64_t) st.st_size!=conf->filesize || clone_file(fd, ifd, conf->filesize)!=0){
+			printf("could not restore %s from the population cache\n", name);
+			close(ifd);
+			close(mfd);
+			return 0;
+		}
+		close(ifd);
+	}
+
+	if(entries && read_all(mfd, entries, tracker_bytes, off)!=0){
+		printf("could not restore the integrity tracker of %s from the population cache\n", name);
+		close(mfd);
+		return 0;
+	}
+	close(mfd);
+
+	printf("restored the population of %s from %s\n", name, conf->popcache);
+	conf->realpop=1;
+
+	//the cached samples will not match the device after this run
+	if(writes_device(conf)){
+		unlink(path);
+	}
+
+	return 1;
+}
+
+void save_population(int fd, char *name, struct user_confs *conf, struct duplicates_info *info, int idproc){
+
+	char key[POPCACHE_KEY_SIZE], path[ENTRY_PATH_SIZE], tmp[ENTRY_PATH_SIZE+8];
+	struct popcache_header hdr;
+	struct popcache_sample samples[POPCACHE_SAMPLES];
+	uint64_t tracker_bytes;
+
+	if(strlen(conf->popcache)==0){
+		return;
+	}
+	if(writes_device(conf)){
+		printf("the population of %s is not cached, the benchmark writes to it\n", name);
+		return;
+	}
+
+	popcache_key(conf, idproc, key);
+	void *entries = tracker_entries(conf, info, (conf->rawdevice==1) ? 0 : idproc, &tracker_bytes);
+
+	bzero(&hdr, sizeof(struct popcache_header));
+	memcpy(hdr.magic, POPCACHE_MAGIC, sizeof(hdr.magic));
+	hdr.version=POPCACHE_VERSION;
+	hdr.tracker_bytes=tracker_bytes;
+	strcpy(hdr.key, key);
+
+	//files are written under a temporary name and renamed, a cache entry is always complete
+	if(conf->rawdevice==1){
+		if(sample_device(fd, conf, key, samples)!=0){
+			printf("could not read %s for the population cache\n", name);
+			return;
+		}
+		hdr.nsamples=POPCACHE_SAMPLES;
+	}else{
+		popcache_path(conf, key, "img", path);
+		snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+		int ifd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if(ifd==-1 || clone_file(ifd, fd, conf->filesize)!=0 || fsync(ifd)!=0 || rename(tmp, path)!=0){
+			perror("Error saving population image");
+			if(ifd!=-1){
+				close(ifd);
+				unlink(tmp);
+			}
+			return;
+		}
+		close(ifd);
+	}
+
+	popcache_path(conf, key, "meta", path);
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	int mfd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	uint64_t off = sizeof(struct popcache_header);
+	int res = (mfd==-1) ? -1 : write_all(mfd, &hdr, sizeof(struct popcache_header), 0);
+	if(res==0 && hdr.nsamples>0){
+		res = write_all(mfd, samples, sizeof(samples), off);
+		off+=sizeof(samples);
+	}
+	if(res==0 && entries){
+		res = write_all(mfd, entries, tracker_bytes, off);
+	}
+	if(res!=0 || fsync(mfd)!=0 || rename(tmp, path)!=0){
+		perror("Error saving population metadata");
+		if(mfd!=-1){
+			close(mfd);
+			unlink(tmp);
+		}
+		return;
+	}
+	close(mfd);
+
+	printf("saved the population of %s in %s\n", name, conf->popcache);
+}
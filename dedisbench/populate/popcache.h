@@ -0,0 +1,51 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef POPCACHE_H
+#define POPCACHE_H
+
+#include <stdint.h>
+#include "../structs/defines.h"
+#include "../benchcore/duplicates/duplicatedist.h"
+
+//Cache of populations with realistic content (population_cache option)
+//Each file (or device) populated is saved in the cache directory with the entries of its
+//integrity tracker, keyed by everything that changes the population (distribution file,
+//seed, sizes, content options, process). Files are restored by cloning the saved image
+//(reflink, copy_file_range otherwise). Devices are not copied: the content of sampled
+//blocks is checksummed and the population is skipped if the device still matches.
+
+#define POPCACHE_MAGIC "DEDISPOP"
+#define POPCACHE_VERSION 1
+#define POPCACHE_KEY_SIZE 1024
+//blocks of a device that are checksummed
+#define POPCACHE_SAMPLES 256
+
+//first bytes of the metadata of a cached population, followed by the samples (devices)
+//and the tracker entries
+struct popcache_header{
+	char magic[8];
+	uint32_t version;
+	uint32_t nsamples;
+	uint64_t tracker_bytes;
+	char key[POPCACHE_KEY_SIZE];
+};
+
+struct popcache_sample{
+	uint64_t blk;
+	uint64_t sum;
+};
+
+//check the population_cache option, returns -1 if it cannot be used
+int check_popcache(struct user_confs *conf);
+
+//restore the population of file idproc (or of the device) opened in fd,
+//returns 1 if it was restored and 0 if it must be populated
+int restore_population(int fd, char *name, struct user_confs *conf, struct duplicates_info *info, int idproc);
+
+//save the population of file idproc (or of the device) opened in fd
+void save_population(int fd, char *name, struct user_confs *conf, struct duplicates_info *info, int idproc);
+
+#endif
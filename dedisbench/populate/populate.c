@@ -14,8 +14,17 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 #include "../utils/random/random.h"
+#include "../utils/timing/timing.h"
 #include "populate.h"
+#include "popcache.h"
+#include "../benchcore/io.h"
+#include "../benchcore/phases/phases.h"
+#include "../benchcore/tracker/tracker.h"
+#include "../benchcore/integrity/integrity.h"
 #include "../benchcore/faults/dedupDegree.h"
 
 
@@ -97,104 +106,317 @@ int destroy_pfile(int procid, struct user_confs *conf){
   return 0;
 }
 
-uint64_t dd_populate(char* name, struct user_confs* conf){
+//consecutive blocks of the population rendered and written at once by a thread
+struct pop_batch{
+  //set when the batch is ready to be written, cleared by the thread once it is written
+  int ready;
+  uint64_t offset;
+  uint64_t nblocks;
+  struct block_info *bi;
+  char *buf;
+};
 
-  //create the file with unique name for process with id procid
-  char command[PATH_SIZE];
-  char count[10];
-  sprintf(count,"%llu",(long long unsigned int)conf->filesize/1024/1024);  
-  strcpy(command,"dd if=/dev/zero of=");
-  strcat(command, name);
-  strcat(command," bs=1M count=");
-  strcat(command, count);
-
-  printf("populating file/device %s with %s\n",name,command);
-  int ret = system(command);
-  if(ret<0){
-    perror("System dd failed");
+//each thread writes its own batch while the next ones are generated
+struct pop_engine{
+  struct user_confs *conf;
+  int fd;
+  //zeros are written instead of realistic content
+  int zero;
+  int nthreads;
+  uint64_t batch_blocks;
+  struct pop_batch *batches;
+  pthread_t *threads;
+  int stop;
+  //bytes of the batches that could not be written
+  uint64_t failed;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+};
+
+struct pop_thread{
+  struct pop_engine *e;
+  struct pop_batch *b;
+};
+
+static int populate_threads(struct user_confs *conf){
+
+  int n = conf->populate_threads;
+
+  if(n<=0){
+    n = sysconf(_SC_NPROCESSORS_ONLN);
   }
+  return (n>0) ? n : 1;
+}
 
-  return conf->filesize;
+static void* pop_thread(void *arg){
+
+  struct pop_engine *e = ((struct pop_thread *) arg)->e;
+  struct pop_batch *b = ((struct pop_thread *) arg)->b;
+  uint64_t bs = e->conf->block_size;
+  uint64_t i;
+  free(arg);
+
+  while(1){
+    pthread_mutex_lock(&e->lock);
+    while(!b->ready && !e->stop){
+      pthread_cond_wait(&e->cond, &e->lock);
+    }
+    if(!b->ready){
+      pthread_mutex_unlock(&e->lock);
+      break;
+    }
+    pthread_mutex_unlock(&e->lock);
+
+    if(!e->zero){
+      for(i=0;i<b->nblocks;i++){
+        get_block_content(b->buf+i*bs, b->bi[i], bs);
+      }
+    }
+
+    uint64_t written=0, len=b->nblocks*bs;
+    while(written<len){
+      ssize_t res = pwrite(e->fd, b->buf+written, len-written, b->offset+written);
+      if(res<=0){
+        perror("Error populating file");
+        __atomic_add_fetch(&e->failed, len-written, __ATOMIC_RELAXED);
+        break;
+      }
+      written+=res;
+    }
+
+    pthread_mutex_lock(&e->lock);
+    b->ready=0;
+    pthread_cond_broadcast(&e->cond);
+    pthread_mutex_unlock(&e->lock);
+  }
 
+  return NULL;
 }
 
+static struct pop_engine* pop_start(int fd, struct user_confs *conf, int zero){
 
+  int i;
+  struct pop_engine *e = malloc(sizeof(struct pop_engine));
+  bzero(e, sizeof(struct pop_engine));
+  e->conf=conf;
+  e->fd=fd;
+  e->zero=zero;
+  e->nthreads=populate_threads(conf);
+  e->batch_blocks = (POPULATE_BATCH>conf->block_size) ? POPULATE_BATCH/conf->block_size : 1;
+  e->batches=calloc(e->nthreads, sizeof(struct pop_batch));
+  e->threads=malloc(sizeof(pthread_t)*e->nthreads);
+  pthread_mutex_init(&e->lock, NULL);
+  pthread_cond_init(&e->cond, NULL);
+
+  for(i=0;i<e->nthreads;i++){
+    struct pop_batch *b = &e->batches[i];
+    //aligned for O_DIRECT
+    if(posix_memalign((void **) &b->buf, 4096, e->batch_blocks*conf->block_size)!=0){
+      perror("Error allocating population buffer");
+      exit(EXIT_FAILURE);
+    }
+    b->bi=malloc(sizeof(struct block_info)*e->batch_blocks);
+    if(zero){
+      memset(b->buf, 0, e->batch_blocks*conf->block_size);
+    }
 
-uint64_t real_populate(int fd, struct user_confs *conf, struct duplicates_info *info, int idproc){
+    struct pop_thread *t = malloc(sizeof(struct pop_thread));
+    t->e=e;
+    t->b=b;
+    if(pthread_create(&e->threads[i], NULL, pop_thread, t)!=0){
+      perror("Error launching population thread");
+      exit(EXIT_FAILURE);
+    }
+  }
 
-  struct stats stat;
+  return e;
+}
 
-  //init random generator
-  //if the seed is always the same the generator generates the same numbers
-  //for each proces the seed = seed + processid or all the processes would
-  //here is seed+nrprocesses so that in the population the load is different
-  //generate the same load
-  init_rand(conf->seed+conf->nprocs);
+//k-th batch of the population, waits until the previous batch of its thread is written
+static struct pop_batch* pop_next(struct pop_engine *e, uint64_t k){
 
-  
-  uint64_t bytes_written=0;
-  while(bytes_written<conf->filesize){
+  struct pop_batch *b = &e->batches[k%e->nthreads];
 
-    char* buf;
-    struct block_info info_write;
+  pthread_mutex_lock(&e->lock);
+  while(b->ready){
+    pthread_cond_wait(&e->cond, &e->lock);
+  }
+  pthread_mutex_unlock(&e->lock);
 
-    //memory block
-    if(conf->odirectf==1){
-      buf = memalign(conf->block_size,conf->block_size);
-    }else{
-      buf = malloc(conf->block_size);
+  return b;
+}
+
+static void pop_submit(struct pop_engine *e, struct pop_batch *b){
+
+  pthread_mutex_lock(&e->lock);
+  b->ready=1;
+  pthread_cond_broadcast(&e->cond);
+  pthread_mutex_unlock(&e->lock);
+}
+
+//waits for every batch to be written, returns the bytes that could not be written
+static uint64_t pop_finish(struct pop_engine *e){
+
+  int i;
+
+  pthread_mutex_lock(&e->lock);
+  e->stop=1;
+  pthread_cond_broadcast(&e->cond);
+  pthread_mutex_unlock(&e->lock);
+
+  for(i=0;i<e->nthreads;i++){
+    pthread_join(e->threads[i], NULL);
+    free(e->batches[i].buf);
+    free(e->batches[i].bi);
+  }
+  pthread_mutex_destroy(&e->lock);
+  pthread_cond_destroy(&e->cond);
+  free(e->batches);
+  free(e->threads);
+  uint64_t failed=e->failed;
+  free(e);
+
+  return failed;
+}
+
+//fill the file (or device) with zeros, natively when possible
+static uint64_t zero_populate(int fd, struct user_confs *conf){
+
+  struct stat st;
+  uint64_t blk, k=0;
+  uint64_t totb=conf->filesize/conf->block_size;
+
+  if(fstat(fd, &st)==0 && S_ISBLK(st.st_mode)){
+    uint64_t range[2] = {0, totb*conf->block_size};
+    if(ioctl(fd, BLKZEROOUT, range)==0){
+      return range[1];
     }
+  }
+  //the file is emptied first as fallocate keeps the existing content
+  else if(ftruncate(fd, 0)==0 && fallocate(fd, 0, 0, totb*conf->block_size)==0){
+    return totb*conf->block_size;
+  }
+
+  printf("zeroing is not supported natively, writing zeros\n");
+  struct pop_engine *e = pop_start(fd, conf, 1);
+  for(blk=0;blk<totb;blk+=e->batch_blocks){
+    struct pop_batch *b = pop_next(e, k++);
+    b->offset=blk*conf->block_size;
+    b->nblocks = (blk+e->batch_blocks<totb) ? e->batch_blocks : totb-blk;
+    pop_submit(e, b);
+  }
 
+  uint64_t failed=pop_finish(e);
 
+  return totb*conf->block_size-failed;
+}
 
-    get_writecontent(buf, conf, info, &stat, 0, &info_write);
 
+uint64_t real_populate(int fd, struct user_confs *conf, struct duplicates_info *info, int idproc){
 
-    if(conf->distout==1 || conf->fault_measure>0){
-      uint64_t idwrite=info_write.cont_id;
+  struct stats stat;
+  bzero(&stat, sizeof(struct stats));
+  uint64_t blk, i, k=0;
+  uint64_t totb=conf->filesize/conf->block_size;
 
-      if(idwrite<info->duplicated_blocks){
-        info->statistics[idwrite]++;
-        if(info->statistics[idwrite]>1){
-           if(info->statistics[idwrite]>info->topblock_dups){
-              info->topblock=idwrite;
-              info->topblock_dups=info->statistics[idwrite];
-           }
-           if(info->statistics[idwrite]<info->botblock_dups){
-              info->botblock=idwrite;
-              info->botblock_dups=info->statistics[idwrite];
-           }
-        }
-        else{
-          if(info->statistics[idwrite]<=1){
+  //init random generator
+  //if the seed is always the same the generator generates the same numbers
+  //for each proces the seed = seed + processid or all the processes would
+  //here is seed+nrprocesses so that in the population the load is different
+  //generate the same load
+  seed_rngs(&stat, conf->seed+conf->nprocs);
+  //unique blocks of each file are distinct
+  init_unique_ids(info, conf->nprocs+1+idproc);
+
+  //the identity of the blocks is chosen here, in order (see replay_population),
+  //the threads of the engine generate and write them
+  struct pop_engine *e = pop_start(fd, conf, 0);
+
+  for(blk=0;blk<totb;blk+=e->batch_blocks){
+    struct pop_batch *b = pop_next(e, k++);
+    b->offset=blk*conf->block_size;
+    b->nblocks = (blk+e->batch_blocks<totb) ? e->batch_blocks : totb-blk;
+
+    for(i=0;i<b->nblocks;i++){
+      struct block_info *info_write = &b->bi[i];
+      next_writecontent(conf, info, &stat, 0, info_write);
+
+      if(conf->distout==1 || conf->fault_measure>0){
+        uint64_t idwrite=info_write->cont_id;
+
+        if(idwrite<info->duplicated_blocks){
+          uint64_t occurrences=count_duplicate(info, idwrite);
+          if(occurrences>1){
+             if(occurrences>info->topblock_dups){
+                info->topblock=idwrite;
+                info->topblock_dups=occurrences;
+             }
+             if(occurrences<info->botblock_dups){
+                info->botblock=idwrite;
+                info->botblock_dups=occurrences;
+             }
+          }
+          else{
             stat.uni++;
           }
         }
       }
-    }
-    int res = pwrite(fd,buf,conf->block_size,bytes_written);
-    if(res<conf->block_size){
-      perror("Error populating file");
-    }
 
-    if(conf->integrity>=1){
-          int pos = (conf->rawdevice==1) ? 0 : idproc;
-          info->content_tracker[pos][bytes_written/conf->block_size].cont_id=info_write.cont_id;     
-          info->content_tracker[pos][bytes_written/conf->block_size].procid=info_write.procid;
-          info->content_tracker[pos][bytes_written/conf->block_size].ts=info_write.ts;
+      track_block(conf, info, (conf->rawdevice==1) ? 0 : idproc, blk+i, info_write);
     }
 
-    free(buf);
-    
-    bytes_written+=conf->block_size;
+    pop_submit(e, b);
   }
 
-  return bytes_written;
-  
+  uint64_t failed=pop_finish(e);
+
+  return totb*conf->block_size-failed;
+}
+
+static void report_population(char *name, uint64_t bytes, uint64_t begin){
+
+  double secs=(now_ns()-begin)/1.0e9;
+  printf("populated %s with %llu MB in %.2f seconds (%.1f MB/s)\n", name, (unsigned long long int) bytes/1024/1024,
+    secs, (secs>0) ? bytes/(1024.0*1024.0)/secs : 0);
+}
+
+//a file that was not fully written must not be used (nor cached) as populated
+static void check_population(char *name, uint64_t bytes, struct user_confs *conf){
+
+  uint64_t size=(conf->filesize/conf->block_size)*conf->block_size;
 
+  if(bytes<size){
+    printf("Error populating %s, only %llu of %llu bytes were written\n", name,
+      (unsigned long long int) bytes, (unsigned long long int) size);
+    exit(EXIT_FAILURE);
+  }
 }
 
+//populate the file (or device) with zeros or with realistic content
+static uint64_t populate_file(int fd, char *name, struct user_confs *conf, struct duplicates_info *info, int idproc){
 
+  uint64_t bytes, begin=now_ns();
+
+  if(conf->populate==DDPOP){
+    printf("populating file/device %s with zeros\n",name);
+    bytes = zero_populate(fd, conf);
+    check_population(name, bytes, conf);
+  }else if(restore_population(fd, name, conf, info, idproc)){
+    bytes = conf->filesize;
+  }else{
+    printf("populating file/device %s with realistic content\n",name);
+    conf->realpop=1;
+    bytes = real_populate(fd, conf, info, idproc);
+    check_population(name, bytes, conf);
+    fsync(fd);
+    save_population(fd, name, conf, info, idproc);
+  }
+  fsync(fd);
+
+  report_population(name, bytes, begin);
+
+  return bytes;
+}
 
 //populate files with content
 void populate(struct user_confs *conf, struct duplicates_info *info){
@@ -212,14 +434,11 @@ void populate(struct user_confs *conf, struct duplicates_info *info){
     nprocs=conf->nprocs;
   }
 
-  uint64_t bytes_populated=0;
+  uint64_t bytes_populated=0, begin=now_ns();
 
   if(conf->rawdevice==0){
 
     //for each process populate its file with size filesize
-    //we use DD for filling a non sparse image
-	//
-	//(!conf->mixedIO && i<nprocs) || (conf->mixedIO && i<nprocs)
     for(i=0;i < nprocs ;i++){
         //create the file with unique name for process with id procid
         char name[PATH_SIZE];
@@ -228,49 +447,23 @@ void populate(struct user_confs *conf, struct duplicates_info *info){
         strcpy(name,conf->tempfilespath);
         strcat(name,TMP_FILE);
         strcat(name,id);
-          
-        if(conf->populate==DDPOP){
-
-          bytes_populated += dd_populate(name, conf);
-
-        }else{
-          
-
-          printf("populating file %s with realistic content\n",name);
-
-          fd = create_pfile(i,conf);
-          bytes_populated += real_populate(fd, conf, info, i);  
-          fsync(fd);     
-          close(fd);
-	  	  
-        }
-
 
+        fd = create_pfile(i,conf);
+        bytes_populated += populate_file(fd, name, conf, info, i);
+        close(fd);
     }
   }  
   else{
 
-    if(conf->populate==DDPOP){
-
-      bytes_populated += dd_populate(conf->rawpath, conf);
-
-
-    }else{
-
-       
-      printf("populating device %s with realistic content\n",conf->rawpath);
-
-      fd = open_rawdev(conf->rawpath,conf);
-      bytes_populated += real_populate(fd, conf, info, 0);
-      fsync(fd);
-      close(fd);
-
-    }
-
+    fd = open_rawdev(conf->rawpath,conf);
+    bytes_populated += populate_file(fd, conf->rawpath, conf, info, 0);
+    close(fd);
 
   }
 
-  printf("File/device(s) population is completed wrote %llu bytes\n", (unsigned long long int)bytes_populated);
+  double secs=(now_ns()-begin)/1.0e9;
+  printf("File/device(s) population is completed wrote %llu bytes in %.2f seconds (%.1f MB/s)\n", (unsigned long long int)bytes_populated,
+    secs, (secs>0) ? bytes_populated/(1024.0*1024.0)/secs : 0);
 
 }
 
@@ -287,50 +480,128 @@ void insert_bug(int fd, int block_size, int offset){
 
 }
 
-int file_integrity(int fd, struct user_confs *conf, struct duplicates_info *info, int idproc, FILE* fpi){
+int replay_integrity(struct user_confs *conf){
 
-  char *buf;
-  int res=0;
+  int p;
 
+  //the requests of a replayed trace are not regenerated
+  if(conf->deterministic!=1 || conf->integrity!=1 || conf->usingfaults || conf->replay){
+    return 0;
+  }
+  //the end of phases with a duration depends on the timing of the run
+  for(p=0;p<conf->nphases;p++){
+    if(conf->phases[p].duration>0){
+      return 0;
+    }
+  }
 
-  //memory block
-  if(conf->odirectf==1){
-    buf = memalign(conf->block_size,conf->block_size);
-  }else{
-    buf = malloc(conf->block_size);
+  return 1;
+}
+
+//regenerate the content written by the population of the file of process idproc (or of the device)
+static void replay_population(struct user_confs *conf, struct duplicates_info *info, int idproc, struct block_info *map){
+
+  struct stats stat;
+  bzero(&stat, sizeof(struct stats));
+  uint64_t blk, totb=conf->filesize/conf->block_size;
+
+  seed_rngs(&stat, conf->seed+conf->nprocs);
+  init_unique_ids(info, conf->nprocs+1+idproc);
+
+  //same order as real_populate
+  for(blk=0;blk<totb;blk++){
+    next_writecontent(conf, info, &stat, 0, &map[blk]);
   }
+}
 
-  uint64_t bytes_read=0;
-  while(bytes_read<conf->filesize){
-
-    struct block_info bf = info->content_tracker[idproc][bytes_read/conf->block_size];
-    //Block was written before
-    if(bf.ts && bf.cont_id){
-      int res_pread = pread(fd,buf,conf->block_size,bytes_read);
-      //printf("read (n: %d, o: %d): %s\n", res_pread, bytes_read, buf);
-      //printf("pread size %lu  offset %lu res %d...\n", conf->block_size, bytes_read, res);
-      if(res_pread<=0){
-        //perror("Error reading in integrity tests\n");
-        printf("Reading block in offset %llu, with size %lu returned %d. Maybe the files was not populated correctly?\n", bytes_read, conf->block_size, res_pread);
-        fprintf(fpi, "Reading block in offset %lu, with size %lu returned %d. Maybe the files was not populated correctly? The next integrity error is related with this message: ", bytes_read, conf->block_size, res_pread);   
-      }
-      res+=compare_blocks(buf, bf, conf->block_size, fpi, 1);
+//regenerate the content written by the first nreqs write requests of process idproc,
+//the generators are used in the same order as in process_run
+static void replay_process(struct user_confs *conf, struct duplicates_info *info, int idproc, uint64_t nreqs, struct block_info *map){
+
+  struct stats stat;
+  bzero(&stat, sizeof(struct stats));
+  stat.beginio=-1;
+  uint64_t r, b;
+  char *buf = malloc(conf->max_request_size);
+  struct block_info info_write[conf->max_request_size/conf->block_size];
+
+  init_io(conf, &stat, idproc);
+  init_unique_ids(info, idproc+1);
+
+  for(r=0;r<nreqs;r++){
+    update_phase(conf, info, &stat, 0);
+
+    uint64_t nblocks=get_request_size(conf, &stat.rng)/conf->block_size;
+    uint64_t iooffset=write_request(buf, nblocks, conf, info, &stat, idproc, info_write);
+    for(b=0;b<nblocks;b++){
+      map[iooffset/conf->block_size+b]=info_write[b];
     }
-    bytes_read+=conf->block_size;
+    stat.phase_ops++;
   }
 
   free(buf);
+}
 
-  return res;
+//expected content of the file of process idproc (or of the device) after the benchmark
+static struct block_info* regen_content_map(struct user_confs *conf, struct duplicates_info *info, int idproc){
+
+  int i;
+  struct block_info *map = calloc(conf->totblocks, sizeof(struct block_info));
+  if(!map){
+    perror("Error allocating the regenerated content map");
+    exit(EXIT_FAILURE);
+  }
+
+  //the generators change the active phase, access pattern and counters
+  struct user_confs rconf = *conf;
+  struct duplicates_info rinfo = *info;
+  uint64_t zerodups=0;
+  rinfo.zerodups=&zerodups;
+  rinfo.dup_shard=NULL;
 
+  if(conf->realpop==1){
+    replay_population(&rconf, &rinfo, idproc, map);
+  }
 
+  if(conf->iotype==WRITE || conf->mixedIO==1){
+    if(conf->rawdevice==0){
+      replay_process(&rconf, &rinfo, idproc, conf->wreqs[idproc], map);
+    }else{
+      //processes write to distinct regions of the device
+      for(i=0;i<conf->nr_proc_w;i++){
+        rconf = *conf;
+        rinfo.classes=info->classes;
+        rinfo.nclasses=info->nclasses;
+        rinfo.alias=info->alias;
+        replay_process(&rconf, &rinfo, i, conf->wreqs[i], map);
+      }
+    }
+  }
+
+  return map;
 }
 
+//compare the file with the content tracked during the run or, in deterministic mode,
+//with the content regenerated for it
+static int check_file(char *path, struct user_confs *conf, struct duplicates_info *info, int idproc, FILE* fpi){
+
+  if(info->content_tracker || info->content_refs){
+    return scan_integrity(path, conf, info, idproc, fpi);
+  }
+
+  struct block_info *map = regen_content_map(conf, info, idproc);
+  struct duplicates_info rinfo = *info;
+  rinfo.content_tracker = &map;
+
+  int res = scan_integrity(path, conf, &rinfo, 0, fpi);
+
+  free(map);
+  return res;
+}
 
 int check_integrity(struct user_confs *conf, struct duplicates_info *info){
 
   int i;
-  int fd;
   int nprocs=0;
 
   FILE *fpi=NULL;
@@ -364,15 +635,11 @@ int check_integrity(struct user_confs *conf, struct duplicates_info *info){
         
         printf("Running for proc %s...\n", name);
 
-        fd = create_pfile(i,conf);
-        integrity_errors += file_integrity(fd,conf, info, i, fpi);
-        close(fd);        
+        integrity_errors += check_file(name, conf, info, i, fpi);
     }
   }  
   else{
-    fd = open_rawdev(conf->rawpath,conf);
-    integrity_errors += file_integrity(fd,conf, info, 0, fpi);
-    close(fd);
+    integrity_errors += check_file(conf->rawpath, conf, info, 0, fpi);
   }
 
   if(integrity_errors>0){
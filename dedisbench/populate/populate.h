@@ -12,6 +12,9 @@
 
 #define TMP_FILE "dedisbench_0010test"
 
+//bytes generated and written at once by each thread of the population
+#define POPULATE_BATCH (4*1024*1024)
+
 
 //Open rawdevice to write
 int open_rawdev(char* rawpath, struct user_confs *conf);
@@ -28,5 +31,9 @@ void populate(struct user_confs *conf, struct duplicates_info *info);
 
 int check_integrity(struct user_confs *conf, struct duplicates_info *info);
 
+//the static integrity check regenerates the expected content instead of tracking it
+//(deterministic mode without online checks, faults or phases that end by time)
+int replay_integrity(struct user_confs *conf);
+
 
 #endif
\ No newline at end of file
@@ -6,6 +6,7 @@
 #define DEFINES_H
 
 #include <db.h>
+#include "../utils/random/random.h"
 
 #define PATH_SIZE 100
 //type of I/O
@@ -24,6 +25,9 @@
 #define SEQUENTIAL 6
 #define UNIFORM 7
 #define TPCC 8
+#define ZIPF 9
+#define HOTSET 10
+#define STREAMS 11
 
 #define NOPOP 0
 #define REPOP 1
@@ -31,6 +35,12 @@
 
 #define MAX_HEADER_SIZE 200
 
+//maximum number of request sizes at the bssplit option
+#define BSSPLIT_MAX 16
+
+//maximum number of phases of the workload schedule
+#define PHASES_MAX 16
+
 #define DFILE	"conf/dist_personalfiles"
 
 #define DISTDB	"benchdbs/distdb/"
@@ -43,13 +53,8 @@ struct stats{
 	//average latency
 	double latency;
 
-	//TODO this sould be an option of the menu...
-	//TODO here we must have a variable that only initiates snapshots if the user specified
-  	//array of periodic Snapshots of average throughput and latency.
-	double *snap_throughput;
-	double *snap_latency;
-	double *snap_ops;
-	uint64_t *snap_time;
+	//periodic snapshots of average throughput and latency are streamed
+	//to the snapshot files (see io/snapshots), only the current one is kept here
 	uint64_t snap_totops;
 	int iter_snap;
   	uint64_t last_snap_time;
@@ -58,10 +63,42 @@ struct stats{
 
 	//total operations performed
 	uint64_t tot_ops;
+	//next block of sequential accesses
+	uint64_t seq_block;
+
+	//run of duplicated blocks being written (see dup_runlength): blocks still to write,
+	//their class, next content id and offset after the last block written
+	uint64_t run_left;
+	uint64_t run_class;
+	uint64_t run_next_id;
+	uint64_t run_offset;
+
+	//write requests issued (including ramp up)
+	uint64_t wreqs;
+
+	//random generator of the process (request sizes and offsets) and independent stream of
+	//the content ids, see seed_rngs
+	struct rng rng;
+	struct rng content_rng;
+
+	//uniform offsets and content ids drawn ahead of time: entries not used yet of each batch
+	//and number of start positions of the offsets
+	uint64_t offsets[RNG_BATCH];
+	uint64_t offsets_left;
+	uint64_t offsets_range;
+	uint64_t ids[RNG_BATCH];
+	uint64_t ids_left;
+
+	//current phase of the workload schedule, I/O operations performed in it
+	//and time when it ends (0 before the first phase starts)
+	int phase;
+	uint64_t phase_ops;
+	uint64_t phase_end;
 	//Since the begin and end time of the tests are not exact about when the
 	//firts or last operations started or ended we register this more accuratelly
 	//for calculating the throughput
 	//exact time before the first I/O operation
+	//(all times are nanoseconds of the monotonic clock, see utils/timing)
 	uint64_t beginio;
 	//exact time after the last I/O operations
 	uint64_t endio;
@@ -80,6 +117,17 @@ struct stats{
 	uint64_t zerod;
 };
 
+//a phase of the workload schedule ([phase<N>] sections of the configuration file)
+struct phase_conf{
+	//duplicate distribution of the phase
+	char distfile[PATH_SIZE];
+	//the phase ends after duration seconds or ops I/O operations of each process
+	uint64_t duration;
+	uint64_t ops;
+	//access pattern of the phase (0 keeps the one of the previous phase)
+	int accesstype;
+};
+
 struct user_confs{
 
 	//Block size in bytes default 4096
@@ -87,6 +135,30 @@ struct user_confs{
 	//total blocks to be addressed at file
     uint64_t totblocks;
 
+	//distribution of request sizes (bssplit option), each request is made of
+	//whole blocks and the content of each block follows the duplicate distribution
+	//without bssplit every request has block_size bytes
+	char bssplit[PATH_SIZE];
+	int nbssplit;
+	uint64_t bssplit_size[BSSPLIT_MAX];
+	int bssplit_perc[BSSPLIT_MAX];
+	//largest request size in bytes
+	uint64_t max_request_size;
+
+	//distribution of the length of runs of duplicated blocks written at consecutive
+	//offsets (dup_runlength option), without it duplicates are not clustered
+	char runlength[PATH_SIZE];
+	int nrunlength;
+	uint64_t runlength_len[BSSPLIT_MAX];
+	int runlength_perc[BSSPLIT_MAX];
+
+	//content of the blocks (see benchcore/content): percentage of the body that is
+	//compressible (CONTENT_LEGACY for the original content) and bits of entropy per byte
+	int compressibility;
+	int entropy;
+	//size in bytes of the cache of rendered duplicated blocks of each process (0 disables it)
+	uint64_t content_cache;
+
 	int start;
 	int finish;
 
@@ -96,12 +168,36 @@ struct user_confs{
 	char printfile[PATH_SIZE];
 	int destroypfile;
 	int printtofile;
+	//interval between throughput and latency snapshots (ns)
+	uint64_t snap_interval;
+	//counters shared with the snapshot coordinator (one per process)
+	struct snap_counters *counters;
+	//live metrics endpoint (TCP port on localhost or UNIX socket path)
+	int metricsf;
+	char metricsendpoint[PATH_SIZE];
+	//stats pages shared with the metrics endpoint (one per process)
+	struct metrics_page *metrics;
 	//log feature 0=disabled 1=enabled
 	int logfeature;
 
 	int accesslog;
 	int accesstype;
 	char accessfilelog[PATH_SIZE];
+	//bins of the access heatmap (see benchcore/accesses/counts.h)
+	uint64_t access_bins;
+
+	//zipfian access pattern: skew of the popularity of blocks
+	double zipf_theta;
+	//hot set access pattern: percentage of the blocks in the hot set, percentage of the
+	//accesses that go to it and operations after which it moves to the next blocks
+	char hotset[PATH_SIZE];
+	int hot_perc;
+	int hot_access;
+	uint64_t hot_shift;
+	//sequential streams access pattern: number of interleaved streams and blocks between
+	//the start of consecutive requests of a stream (0 for contiguous requests)
+	int nstreams;
+	uint64_t stream_stride;
 
 	//
 	int distout;
@@ -115,6 +211,15 @@ struct user_confs{
 
     int rawdevice;
     char rawpath[PATH_SIZE];
+    //regions of the raw device (see benchcore/regions): alignment in bytes (0 for the
+    //block size) and percentage of each region shared with the next ones
+    uint64_t region_align;
+    int region_overlap;
+    //blocks between the start of consecutive regions, blocks of each region and
+    //first block of the last region
+    uint64_t region_stride;
+    uint64_t region_blocks;
+    uint64_t region_last;
 
     //TEST type PEAK or NOMINAL
     int testtype;
@@ -146,6 +251,28 @@ struct user_confs{
 	char distfile[PATH_SIZE];
 	int distf;
 
+	//content of unique blocks derives from the seed instead of the current time,
+	//so that runs with the same seed write the same bytes
+	int deterministic;
+	//population with realistic content was performed
+	int realpop;
+	//threads of the population (0 for one per CPU)
+	int populate_threads;
+	//directory of the population cache (see populate/popcache.h)
+	char popcache[PATH_SIZE];
+	//write requests of each process (for replay_integrity)
+	uint64_t *wreqs;
+
+	//workload schedule, each phase has its own distribution and access pattern
+	struct phase_conf phases[PHASES_MAX];
+	int nphases;
+
+	//replay of a block I/O trace ([replay] section) instead of synthesized accesses,
+	//replay_speed scales the inter-arrival times of the trace (0 issues requests without delays)
+	int replay;
+	char replayfile[PATH_SIZE];
+	double replay_speed;
+
 	//output dirstibution file
 	char outputfile[PATH_SIZE];
 	int auxtype;
@@ -153,8 +280,17 @@ struct user_confs{
 	int fsyncf;
 	int odirectf;
 
+	//clock used for measuring I/O operations (CLOCK_AUTO or CLOCK_MONO)
+	int clocktype;
+
 	int integrity;
 	char integrityfile[PATH_SIZE];
+	//TRACKER_FULL or TRACKER_COMPACT (see benchcore/tracker) and optional sparse file
+	//where the tracker is mapped
+	int tracker;
+	char trackerfile[PATH_SIZE];
+	//threads of the static integrity check (0 for one per CPU)
+	int integrity_threads;
 
 	//print dist file DB
 	DB **dbpdist; // DB structure handle
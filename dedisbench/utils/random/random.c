@@ -4,36 +4,58 @@
  */
 
 //random generation
-#include <assert.h>
 #include "random.h"
-#include "randomgen/SFMT.c"
 
-//TODO: find a more suitable library in the future to prevent the tweaks we are doing below
-
-void init_rand(uint64_t seed){
-
-init_gen_rand(seed);
+//splitmix64, spreads the seed over the state of the generator
+static uint64_t splitmix64(uint64_t *x){
 
+	uint64_t z=(*x+=0x9e3779b97f4a7c15ULL);
+	z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+	z=(z^(z>>27))*0x94d049bb133111ebULL;
+	return z^(z>>31);
 }
 
+void rng_seed(struct rng *r, uint64_t seed){
 
-//generates random number between 0 and max
-//TODO: maybe the distribution is not completely uniform due to the
-//correction done below
-uint64_t genrand(uint64_t max){
+	int i;
+	for(i=0;i<4;i++){
+		r->s[i]=splitmix64(&seed);
+	}
+}
 
-        //the library generates between 0 and max uint32_t
-    uint64_t t = gen_rand32();
+void rng_jump(struct rng *r){
+
+	static const uint64_t jump[]={0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+	uint64_t s[4]={0, 0, 0, 0};
+	int i, b, j;
+
+	for(i=0;i<4;i++){
+		for(b=0;b<64;b++){
+			if(jump[i] & (1ULL<<b)){
+				for(j=0;j<4;j++){
+					s[j]^=r->s[j];
+				}
+			}
+			rng_next(r);
+		}
+	}
+	for(j=0;j<4;j++){
+		r->s[j]=s[j];
+	}
+}
 
-    //this must have equal propability, if t is higher than the last number that
-    //int32-max is divisible for with remainig zero.
-    //we must calculate a random number again, or it stops having equal probability.
-    while(t>=INT64_MAX/max * max){
+void rng_fill(struct rng *r, uint64_t *out, size_t n){
 
-          t = gen_rand64();
+	size_t i;
+	for(i=0;i<n;i++){
+		out[i]=rng_next(r);
+	}
+}
 
-    }
+void rng_fill_range(struct rng *r, uint64_t max, uint64_t *out, size_t n){
 
-    //this way we only et a random from 0 to max
-    return t%max;
-}
\ No newline at end of file
+	size_t i;
+	for(i=0;i<n;i++){
+		out[i]=rng_range(r, max);
+	}
+}
@@ -6,14 +6,72 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
-#define MEXP 19937
 //random generation
 #include <stdint.h>
+#include <stddef.h>
 
-void init_rand(uint64_t seed);
+//xoshiro256** generator (D. Blackman and S. Vigna), each benchmark process (or population)
+//has its own state so that there is no global generator
+struct rng{
+	uint64_t s[4];
+};
 
+//draws prepared ahead of time by the users of the bulk functions
+#define RNG_BATCH 256
 
-//generates random number between 0 and max
-uint64_t genrand(uint64_t max);
+//the same seed always generates the same numbers
+void rng_seed(struct rng *r, uint64_t seed);
+
+//moves the generator 2^128 numbers ahead, to derive independent streams from the same seed
+void rng_jump(struct rng *r);
+
+static inline uint64_t rng_rotl(uint64_t x, int k){
+	return (x<<k) | (x>>(64-k));
+}
+
+//64 random bits
+static inline uint64_t rng_next(struct rng *r){
+
+	uint64_t *s=r->s;
+	uint64_t res=rng_rotl(s[1]*5, 7)*9;
+	uint64_t t=s[1]<<17;
+
+	s[2]^=s[0];
+	s[3]^=s[1];
+	s[1]^=s[2];
+	s[0]^=s[3];
+	s[2]^=t;
+	s[3]=rng_rotl(s[3], 45);
+
+	return res;
+}
+
+//generates random number between 0 and max (excluded, 0 if max is 0) without bias,
+//with Lemire's multiply and shift reduction instead of a division
+static inline uint64_t rng_range(struct rng *r, uint64_t max){
+
+	unsigned __int128 m=(unsigned __int128) rng_next(r)*max;
+	uint64_t l=(uint64_t) m;
+
+	//only the values that would make some results more likely are discarded
+	if(l<max){
+		uint64_t t=-max%max;
+		while(l<t){
+			m=(unsigned __int128) rng_next(r)*max;
+			l=(uint64_t) m;
+		}
+	}
+
+	return (uint64_t) (m>>64);
+}
+
+//uniform double in [0, 1[ with 53 random bits
+static inline double rng_double(struct rng *r){
+	return (rng_next(r)>>11)*(1.0/(1ULL<<53));
+}
+
+//bulk versions that fill n entries of out ahead of time
+void rng_fill(struct rng *r, uint64_t *out, size_t n);
+void rng_fill_range(struct rng *r, uint64_t max, uint64_t *out, size_t n);
 
 #endif
@@ -0,0 +1,109 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <time.h>
+#include "timing.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+//time taken to calibrate the TSC against CLOCK_MONOTONIC_RAW
+#define CALIBRATION_NS 50000000ULL
+//ns = (ticks * tsc_mult) >> TSC_SHIFT
+#define TSC_SHIFT 32
+
+static int use_tsc=0;
+static uint64_t tsc_base=0;
+static uint64_t tsc_base_ns=0;
+static uint64_t tsc_mult=0;
+static uint64_t epoch_offset=0;
+
+
+static uint64_t mono_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec;
+}
+
+#ifdef HAVE_TSC
+//the TSC only ticks at a constant rate in all P/C-states if it is invariant
+//CPUID.80000007H:EDX[8]
+static int invariant_tsc(void){
+	unsigned int eax, ebx, ecx, edx;
+
+	if(__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx)==0 || eax<0x80000007){
+		return 0;
+	}
+	if(__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)==0){
+		return 0;
+	}
+	return (edx>>8) & 1;
+}
+
+static inline uint64_t read_tsc(void){
+	unsigned int aux;
+	//rdtscp waits for the previous instructions to complete
+	return __rdtscp(&aux);
+}
+
+static void calibrate_tsc(void){
+
+	uint64_t ns1=mono_ns();
+	uint64_t t1=read_tsc();
+	uint64_t ns2=ns1;
+	while(ns2-ns1<CALIBRATION_NS){
+		ns2=mono_ns();
+	}
+	uint64_t t2=read_tsc();
+
+	tsc_mult=(uint64_t)(((unsigned __int128)(ns2-ns1)<<TSC_SHIFT)/(t2-t1));
+	tsc_base=t2;
+	tsc_base_ns=ns2;
+
+	printf("Using invariant TSC for timing (%.3f MHz)\n", (t2-t1)/((ns2-ns1)/1.0e3));
+}
+#endif
+
+void init_timing(int clocktype){
+
+	struct timespec wall;
+
+#ifdef HAVE_TSC
+	if(clocktype==CLOCK_AUTO && invariant_tsc()){
+		calibrate_tsc();
+		use_tsc=1;
+	}
+#endif
+	if(!use_tsc){
+		printf("Using the monotonic clock for timing\n");
+	}
+	//do not duplicate the message in the buffers of forked processes
+	fflush(stdout);
+
+	clock_gettime(CLOCK_REALTIME, &wall);
+	epoch_offset=((uint64_t)wall.tv_sec*1000000000ULL+wall.tv_nsec)-now_ns();
+}
+
+uint64_t now_ns(void){
+
+#ifdef HAVE_TSC
+	if(use_tsc){
+		uint64_t ticks=read_tsc()-tsc_base;
+		return tsc_base_ns+(uint64_t)(((unsigned __int128)ticks*tsc_mult)>>TSC_SHIFT);
+	}
+#endif
+
+	return mono_ns();
+}
+
+uint64_t timing_epoch_offset_ns(void){
+	return epoch_offset;
+}
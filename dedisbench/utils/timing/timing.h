@@ -0,0 +1,25 @@
+/* DEDISbench
+ * (c) 2010 2017 INESC TEC and U. Minho
+ * Written by J. Paulo
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+//clock used for measuring I/O operations
+#define CLOCK_AUTO 0
+#define CLOCK_MONO 1
+
+//calibrate the clock, must be called once before forking the benchmark processes
+//with CLOCK_AUTO the TSC is used if the CPU exposes an invariant TSC
+void init_timing(int clocktype);
+
+//current time in nanoseconds of a monotonic clock (not affected by NTP steps)
+uint64_t now_ns(void);
+
+//add this value to now_ns() timestamps to get wall clock time in nanoseconds
+uint64_t timing_epoch_offset_ns(void);
+
+#endif
@@ -3,6 +3,9 @@
  * Written by M. Freitas
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "utils.h"
 
 int powr(int base, int exp){
@@ -24,3 +27,64 @@ int order_of_magnitude(unsigned long long int key){
 	}
 	return bucket;
 }
+
+//parse a size with an optional k, m or g suffix (eg: 4k, 64k, 1m)
+uint64_t parse_size(char *str){
+
+	char *end;
+	uint64_t size = strtoull(str, &end, 10);
+
+	switch(*end){
+		case 'k': case 'K': size*=1024; break;
+		case 'm': case 'M': size*=1024*1024; break;
+		case 'g': case 'G': size*=1024*1024*1024ULL; break;
+		default: break;
+	}
+
+	return size;
+}
+
+//parse a list of <value>/<percentage> pairs separated by ':' (eg: 4k/50:64k/30:1m/20)
+//returns the number of pairs or -1 if the list is malformed or percentages do not add up to 100
+int parse_split(const char *list, uint64_t *values, int *perc, int max){
+
+	char str[strlen(list)+1];
+	strcpy(str, list);
+
+	int total=0;
+	int n=0;
+	char *saveptr;
+	char *token = strtok_r(str, ":", &saveptr);
+	while(token){
+
+		if(n==max){
+			printf("'%s' has more than %d entries\n", list, max);
+			return -1;
+		}
+
+		char *p = strchr(token, '/');
+		if(!p){
+			printf("entry '%s' must be <value>/<percentage>\n", token);
+			return -1;
+		}
+		*p='\0';
+
+		values[n]=parse_size(token);
+		perc[n]=atoi(p+1);
+		if(perc[n]<0){
+			printf("entry '%s/%d' has a negative percentage\n", token, perc[n]);
+			return -1;
+		}
+		total+=perc[n];
+		n++;
+
+		token = strtok_r(NULL, ":", &saveptr);
+	}
+
+	if(total!=100){
+		printf("percentages of '%s' must add up to 100 (got %d)\n", list, total);
+		return -1;
+	}
+
+	return n;
+}
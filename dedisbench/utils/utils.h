@@ -6,7 +6,11 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdint.h>
+
 int powr(int, int);
 int order_of_magnitude(unsigned long long int);
+uint64_t parse_size(char *str);
+int parse_split(const char *list, uint64_t *values, int *perc, int max);
 
 #endif